@@ -129,6 +129,10 @@ MainWindow::MainWindow(QWidget *parent)
     editorToolbar->addAction(_actionModeWire);
     editorToolbar->addSeparator();
     editorToolbar->addAction(_actionRouteStraightAngles);
+    editorToolbar->addAction(_actionRouteAroundObstacles);
+    editorToolbar->addAction(_actionRerouteAttachedWires);
+    editorToolbar->addAction(_actionShowWireHops);
+    editorToolbar->addAction(_actionGhostDragging);
     editorToolbar->addSeparator();
     editorToolbar->addAction(_actionGenerateNetlist);
     addToolBar(editorToolbar);
@@ -322,6 +326,46 @@ void MainWindow::createActions()
         settingsChanged();
     });
 
+    // Route around obstacles
+    _actionRouteAroundObstacles = new QAction("Route around nodes", this);
+    _actionRouteAroundObstacles->setCheckable(true);
+    _actionRouteAroundObstacles->setChecked(_settings.routeAroundObstacles);
+    _actionRouteAroundObstacles->setToolTip("Route new wires around the nodes and along free grid lines");
+    connect(_actionRouteAroundObstacles, &QAction::toggled, [this](bool checked){
+        _settings.routeAroundObstacles = checked;
+        settingsChanged();
+    });
+
+    // Re-route attached wires
+    _actionRerouteAttachedWires = new QAction("Re-route wires", this);
+    _actionRerouteAttachedWires->setCheckable(true);
+    _actionRerouteAttachedWires->setChecked(_settings.rerouteAttachedWires);
+    _actionRerouteAttachedWires->setToolTip("Re-route the ends of the wires attached to the nodes being moved");
+    connect(_actionRerouteAttachedWires, &QAction::toggled, [this](bool checked){
+        _settings.rerouteAttachedWires = checked;
+        settingsChanged();
+    });
+
+    // Show wire hops
+    _actionShowWireHops = new QAction("Wire hops", this);
+    _actionShowWireHops->setCheckable(true);
+    _actionShowWireHops->setChecked(_settings.showWireHops);
+    _actionShowWireHops->setToolTip("Draw a hop where wires cross without being connected");
+    connect(_actionShowWireHops, &QAction::toggled, [this](bool checked){
+        _settings.showWireHops = checked;
+        settingsChanged();
+    });
+
+    // Ghost dragging
+    _actionGhostDragging = new QAction("Ghost dragging", this);
+    _actionGhostDragging->setCheckable(true);
+    _actionGhostDragging->setChecked(_settings.ghostDragging);
+    _actionGhostDragging->setToolTip("Drag a picture of the selection and move the items once they are dropped");
+    connect(_actionGhostDragging, &QAction::toggled, [this](bool checked){
+        _settings.ghostDragging = checked;
+        settingsChanged();
+    });
+
     // Generate netlist
     _actionGenerateNetlist = new QAction("Generate netlist", this);
     _actionGenerateNetlist->setIcon( QIcon( ":/netlist.svg" ) );
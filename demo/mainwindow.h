@@ -69,6 +69,10 @@ private:
     QAction* _actionShowGrid;
     QAction* _actionFitAll;
     QAction* _actionRouteStraightAngles;
+    QAction* _actionRouteAroundObstacles;
+    QAction* _actionRerouteAttachedWires;
+    QAction* _actionShowWireHops;
+    QAction* _actionGhostDragging;
     QAction* _actionGenerateNetlist;
     QAction* _actionDebugMode;
 };
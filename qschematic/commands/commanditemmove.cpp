@@ -2,6 +2,7 @@
 #include "commanditemmove.h"
 #include "../items/item.h"
 #include "../items/wire.h"
+#include "../scene.h"
 
 #include <memory>
 
@@ -68,6 +69,14 @@ void CommandItemMove::redo()
 
 void CommandItemMove::simplifyWires() const
 {
+    // Only the wires that changed need to be simplified
+    if (!_items.isEmpty()) {
+        if (Scene* scene = _items.first()->scene()) {
+            scene->wire_manager()->simplify_changed_wires();
+            return;
+        }
+    }
+
     for (const auto& item : _items) {
         if (auto wire = item->sharedPtr<Wire>()) {
             wire->simplify();
@@ -310,7 +310,11 @@ void Connector::alignLabel()
 
 void Connector::calculateSymbolRect()
 {
-    _symbolRect = QRectF(-SIZE*_settings.gridSize/2.0, -SIZE*_settings.gridSize/2.0, SIZE*_settings.gridSize, SIZE*_settings.gridSize);
+    const QRectF rect(-SIZE*_settings.gridSize/2.0, -SIZE*_settings.gridSize/2.0, SIZE*_settings.gridSize, SIZE*_settings.gridSize);
+    if (rect != _symbolRect) {
+        prepareGeometryChange();
+        _symbolRect = rect;
+    }
 }
 
 void Connector::calculateTextDirection()
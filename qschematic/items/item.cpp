@@ -220,7 +220,8 @@ void Item::setSettings(const Settings& settings)
         setPos(_settings.snapToGrid(pos()));
     }
 
-    // Store the new settings
+    // Store the new settings. The sizes of the grid, handles and highlight rects can change the bounding rect.
+    prepareGeometryChange();
     _settings = settings;
 
     // Let everyone know
@@ -262,6 +263,10 @@ bool Item::isHighlighted() const
 
 void Item::setHighlighted(bool highlighted)
 {
+    // The bounding rect of some items grows when they are highlighted
+    if (highlighted != _highlighted) {
+        prepareGeometryChange();
+    }
     _highlighted = highlighted;
 
     // Ripple through children
@@ -275,6 +280,9 @@ void Item::setHighlighted(bool highlighted)
 
 void Item::setHighlightEnabled(bool enabled)
 {
+    if (enabled != _highlightEnabled) {
+        prepareGeometryChange();
+    }
     _highlightEnabled = enabled;
     _highlighted = false;
 }
@@ -345,6 +353,13 @@ QVariant Item::itemChange(QGraphicsItem::GraphicsItemChange change, const QVaria
         }
         return newPos;
     }
+    case QGraphicsItem::ItemSelectedChange:
+        // Selected items are highlighted and can have handles, both can grow the bounding rect
+        prepareGeometryChange();
+        return value;
+    case QGraphicsItem::ItemSelectedHasChanged:
+        emit selectedChanged(*this, value.toBool());
+        return value;
     case QGraphicsItem::ItemParentChange:
         if (parentObject()) {
             disconnect(parentObject(), nullptr, this, nullptr);
@@ -130,6 +130,7 @@ namespace QSchematic
         void movedInScene(Item& item);
         void rotated(Item& item, const qreal rotation);
         void highlightChanged(const Item& item, bool isHighlighted);
+        void selectedChanged(Item& item, bool isSelected);
         void settingsChanged();
 
     protected:
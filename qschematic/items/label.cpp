@@ -117,6 +117,10 @@ bool Label::hasConnectionPoint() const
 
 void Label::setConnectionPoint(const QPointF& connectionPoint)
 {
+    // The line to the connection point is part of the bounding rect while highlighted
+    if (isHighlighted()) {
+        prepareGeometryChange();
+    }
     _connectionPoint = connectionPoint;
 
     Item::update();
@@ -124,6 +128,8 @@ void Label::setConnectionPoint(const QPointF& connectionPoint)
 
 void Label::calculateTextRect()
 {
+    prepareGeometryChange();
+
     QFontMetricsF fontMetrics(_font);
     _textRect = fontMetrics.boundingRect(_text);
     _textRect.adjust(-LABEL_TEXT_PADDING, -LABEL_TEXT_PADDING, LABEL_TEXT_PADDING, LABEL_TEXT_PADDING);
@@ -153,6 +153,8 @@ bool Node::addConnector(const std::shared_ptr<Connector>& connector)
 
     _connectors << connector;
 
+    emit connectorAdded(connector);
+
     return true;
 }
 
@@ -170,6 +172,8 @@ bool Node::removeConnector(const std::shared_ptr<Connector>& connector)
     _connectors.removeAll(connector);
     _specialConnectors.removeAll(connector);
 
+    emit connectorRemoved(connector);
+
     return true;
 }
 
@@ -184,7 +188,11 @@ void Node::clearConnectors()
     }
 
     // Clear the local list
+    const auto connectors = std::move(_connectors);
     _connectors.clear();
+    for (const auto& connector : connectors) {
+        emit connectorRemoved(connector);
+    }
 }
 
 QList<std::shared_ptr<Connector>> Node::connectors() const
@@ -19,6 +19,10 @@ namespace QSchematic {
         Q_OBJECT
         Q_DISABLE_COPY_MOVE(Node)
 
+    signals:
+        void connectorAdded(const std::shared_ptr<Connector>& connector);
+        void connectorRemoved(const std::shared_ptr<Connector>& connector);
+
     public:
         Node(int type = Item::NodeType, QGraphicsItem* parent = nullptr);
         ~Node() override;
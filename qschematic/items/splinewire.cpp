@@ -47,7 +47,16 @@ void SplineWire::paint(QPainter* painter, const QStyleOptionGraphicsItem* option
     painter->setPen(penLine);
     painter->setBrush(brushLine);
 
-    painter->drawPath(path());
+    // Only straight wires hop over the wires they cross, curves don't follow their segments
+    const auto& points = pointsRelative();
+    const auto& hops = hopsRelative();
+    if (points.count() == 2 && !hops.isEmpty()) {
+        QPainterPath path(points.first());
+        lineToWithHops(path, points.last(), hops);
+        painter->drawPath(path);
+    } else {
+        painter->drawPath(path());
+    }
 
     // Draw the junction poins
     QPen penJunction;
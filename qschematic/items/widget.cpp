@@ -96,5 +96,9 @@ Widget::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWidget
 void
 Widget::update_rect()
 {
-    m_rect = sizeRect().adjusted(-m_border_width, -m_border_width, m_border_width, m_border_width).toRect();
+    const QRect rect = sizeRect().adjusted(-m_border_width, -m_border_width, m_border_width, m_border_width).toRect();
+    if (rect != m_rect) {
+        prepareGeometryChange();
+        m_rect = rect;
+    }
 }
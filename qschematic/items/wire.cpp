@@ -17,9 +17,12 @@
 #include <QtMath>
 #include <QMenu>
 
+#include <algorithm>
+
 const qreal BOUNDING_RECT_PADDING = 6.0;
 const qreal HANDLE_SIZE = 3.0;
 const qreal WIRE_SHAPE_PADDING = 10;
+const qreal HOP_RADIUS = 5;
 const QColor COLOR                     = QColor("#000000");
 const QColor COLOR_HIGHLIGHTED         = QColor("#dc2479");
 const QColor COLOR_SELECTED            = QColor("#0f16af");
@@ -105,6 +108,7 @@ void Wire::from_container(const gpds::container& container)
             m_points.append(point(pointContainer->get_value<double>("x").value_or(0),
                                   pointContainer->get_value<double>("y").value_or(0)));
         }
+        points_changed();
     }
 
     update();
@@ -213,8 +217,12 @@ void Wire::calculateBoundingRect()
             bottomRight.setY(point.y());
     }
 
-    // Create the rectangle
-    _rect = QRectF(topLeft, bottomRight);
+    // Create the rectangle. The scene's index needs to know before the bounding rect changes.
+    const QRectF rect(topLeft, bottomRight);
+    if (rect != _rect) {
+        prepareGeometryChange();
+        _rect = rect;
+    }
 }
 
 void Wire::setRenameAction(QAction* action)
@@ -247,6 +255,7 @@ void Wire::removeFirstPoint()
     }
     prepareGeometryChange();
     m_points.removeFirst();
+    points_changed();
     calculateBoundingRect();
 }
 
@@ -258,6 +267,7 @@ void Wire::removeLastPoint()
 
     prepareGeometryChange();
     m_points.removeLast();
+    points_changed();
     calculateBoundingRect();
 }
 
@@ -505,7 +515,16 @@ void Wire::paint(QPainter* painter, const QStyleOptionGraphicsItem* option, QWid
     painter->setPen(penLine);
     painter->setBrush(brushLine);
     const auto& points = pointsRelative();
-    painter->drawPolyline(points.constData(), points.count());
+    const auto& hops = hopsRelative();
+    if (hops.isEmpty() || points.isEmpty()) {
+        painter->drawPolyline(points.constData(), points.count());
+    } else {
+        QPainterPath path(points.first());
+        for (int i = 1; i < points.count(); i++) {
+            lineToWithHops(path, points.at(i), hops);
+        }
+        painter->drawPath(path);
+    }
 
     // Draw the junction poins
     int junctionRadius = 4;
@@ -551,31 +570,24 @@ QVariant Wire::itemChange(QGraphicsItem::GraphicsItemChange change, const QVaria
         move(movedBy);
         return newPos;
     }
-    case ItemPositionHasChanged:
+    case ItemPositionHasChanged: {
         if (!scene()) {
             break;
         }
-        // Move points to their connectors
-        for (const auto& conn : scene()->connectors()) {
-            bool isSelected = false;
-            // Check if the connector's node is selected
-            for (const auto& item : scene()->selectedTopLevelItems()) {
-                auto node = item->sharedPtr<Node>();
-                if (node) {
-                    if (node->connectors().contains(conn)) {
-                        isSelected = true;
-                        break;
-                    }
-                }
+        // Move points to their connectors (copy the list as moving the points can change it)
+        const auto connectors = scene()->wire_manager()->attached_connectors(this);
+        for (const wire_system::connectable* conn : connectors) {
+            // Skip the connectors whose node moves with the wire
+            if (scene()->connectorMovesWithSelection(conn)) {
+                continue;
             }
             // Move point onto the connector
-            if (!isSelected && scene()->wire_manager()->attached_wire(conn.get()) == this) {
-                int index = scene()->wire_manager()->attached_point(conn.get());
-                QVector2D moveBy(conn->scenePos() - pointsAbsolute().at(index));
-                move_point_by(index, moveBy);
-            }
+            int index = scene()->wire_manager()->attached_point(conn);
+            QVector2D moveBy(conn->position() - pointsAbsolute().at(index));
+            move_point_by(index, moveBy);
         }
         break;
+    }
     case ItemSelectedHasChanged:
         if (value.toBool()) {
             setZValue(zValue()+1);
@@ -701,6 +713,59 @@ bool Wire::movingWirePoint() const
     }
 }
 
+/**
+ * Returns the points where the horizontal segments of the wire hop over other wires.
+ * They come from the crossings cached by the wire manager, which the scene keeps up to
+ * date, so this is safe to call while painting.
+ */
+QVector<QPointF> Wire::hopsRelative()
+{
+    QVector<QPointF> hops;
+    if (!_settings.showWireHops || !manager()) {
+        return hops;
+    }
+
+    for (const auto& crossing : manager()->crossings(this)) {
+        if (crossing.horizontal) {
+            hops << crossing.point - pos();
+        }
+    }
+
+    return hops;
+}
+
+/**
+ * Adds a line from the current position of the path to the point. If the line is
+ * horizontal it hops over the wires it crosses.
+ */
+void Wire::lineToWithHops(QPainterPath& path, const QPointF& to, const QVector<QPointF>& hops) const
+{
+    const QPointF from = path.currentPosition();
+    if (hops.isEmpty() || from.y() != to.y()) {
+        path.lineTo(to);
+        return;
+    }
+
+    // The hops that fit on the line, in the order they are reached
+    QVector<qreal> hopsX;
+    for (const QPointF& hop : hops) {
+        if (hop.y() == from.y() && qMin(from.x(), to.x()) + HOP_RADIUS <= hop.x() && hop.x() <= qMax(from.x(), to.x()) - HOP_RADIUS) {
+            hopsX << hop.x();
+        }
+    }
+    const bool forward = from.x() < to.x();
+    std::sort(hopsX.begin(), hopsX.end(), [forward](qreal a, qreal b) {
+        return forward ? a < b : a > b;
+    });
+
+    // Half circles above the line
+    for (const qreal x : hopsX) {
+        path.lineTo(forward ? x - HOP_RADIUS : x + HOP_RADIUS, from.y());
+        path.arcTo(QRectF(x - HOP_RADIUS, from.y() - HOP_RADIUS, 2 * HOP_RADIUS, 2 * HOP_RADIUS), forward ? 180 : 0, forward ? -180 : 180);
+    }
+    path.lineTo(to);
+}
+
 void Wire::about_to_change()
 {
     prepareGeometryChange();
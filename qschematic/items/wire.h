@@ -8,6 +8,7 @@
 #include <QAction>
 
 class QVector2D;
+class QPainterPath;
 
 namespace QSchematic {
 
@@ -52,6 +53,8 @@ namespace QSchematic {
         void copyAttributes(Wire& dest) const;
         void calculateBoundingRect();
         void setRenameAction(QAction* action);
+        QVector<QPointF> hopsRelative();
+        void lineToWithHops(QPainterPath& path, const QPointF& to, const QVector<QPointF>& hops) const;
 
         void mousePressEvent(QGraphicsSceneMouseEvent* event) override;
         void mouseReleaseEvent(QGraphicsSceneMouseEvent* event) override;
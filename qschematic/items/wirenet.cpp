@@ -128,6 +128,38 @@ bool WireNet::removeWire(const std::shared_ptr<wire> wire)
     return true;
 }
 
+void WireNet::take_wires(const std::shared_ptr<net>& other, const QList<std::shared_ptr<wire>>& wires)
+{
+    auto otherWireNet = std::dynamic_pointer_cast<WireNet>(other);
+    bool otherLabelMoved = false;
+
+    net::take_wires(other, wires);
+
+    for (const auto& wire : wires) {
+        if (!wire || wire->net().get() != this) {
+            continue;
+        }
+        if (auto wire_net = std::dynamic_pointer_cast<Wire>(wire)) {
+            // Move the signals to this net
+            if (otherWireNet) {
+                disconnect(wire_net.get(), nullptr, otherWireNet.get(), nullptr);
+                otherLabelMoved |= otherWireNet->_label->parentItem() == wire_net.get();
+            }
+            connect(wire_net.get(), &Wire::pointMoved, this, &WireNet::wirePointMoved);
+            connect(wire_net.get(), &Wire::highlightChanged, this, &WireNet::wireHighlightChanged);
+            connect(wire_net.get(), &Wire::toggleLabelRequested, this, &WireNet::toggleLabel);
+            connect(wire_net.get(), &Wire::moved, this, [=] { updateLabelPos(); });
+        }
+    }
+
+    updateLabelPos(true);
+
+    // The label of the other net has to find another wire
+    if (otherLabelMoved) {
+        otherWireNet->updateLabelPos(true);
+    }
+}
+
 void WireNet::simplify()
 {
     for (auto& wire : wires()) {
@@ -169,19 +201,13 @@ QList<std::shared_ptr<WireNet>> WireNet::nets() const
 {
     QList<std::shared_ptr<WireNet>> list;
 
-    for (auto& net : manager()->nets()) {
-        if (!net) {
-            continue;
-        }
-
-        if (net->name().isEmpty()) {
-            continue;
-        }
+    if (!manager() || name().isEmpty()) {
+        return list;
+    }
 
-        if (QString::compare(net->name(), name(), Qt::CaseSensitive) == 0) {
-            if (auto otherNet = std::dynamic_pointer_cast<WireNet>(net)) {
-                list.append(otherNet);
-            }
+    for (const auto& net : manager()->nets_named(name())) {
+        if (auto otherNet = std::dynamic_pointer_cast<WireNet>(net)) {
+            list.append(otherNet);
         }
     }
 
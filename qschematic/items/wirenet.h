@@ -39,6 +39,7 @@ namespace QSchematic {
 
         bool addWire(const std::shared_ptr<wire>& wire) override;
         bool removeWire(const std::shared_ptr<wire> wire) override;
+        void take_wires(const std::shared_ptr<net>& other, const QList<std::shared_ptr<wire>>& wires) override;
         void simplify();
         void set_name(const QString& name) override;
         void setHighlighted(bool highlighted);
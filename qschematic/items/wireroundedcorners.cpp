@@ -88,19 +88,20 @@ void WireRoundedCorners::paint(QPainter* painter, const QStyleOptionGraphicsItem
         painter->setBrush(brushLine);
 
         // Render
+        const auto& hops = hopsRelative();
         for (int i = 0; i < scenePoints.count(); i++) {
             // Retrieve point
             point point = scenePoints.at(i);
 
             // If it's the last point
             if (i == scenePoints.count()-1) {
-                path.lineTo(point.toPointF());
+                lineToWithHops(path, point.toPointF(), hops);
             }
             // If it's the first point
             else if (i == 0) {
                 wire_system::point nPoint = scenePoints.at(i + 1);
                 path.moveTo(point.toPointF());
-                path.lineTo(Utils::centerPoint(point.toPointF(), nPoint.toPointF()));
+                lineToWithHops(path, Utils::centerPoint(point.toPointF(), nPoint.toPointF()), hops);
             }
             // It's a point in the middle of the wire
             else {
@@ -143,12 +144,12 @@ void WireRoundedCorners::paint(QPainter* painter, const QStyleOptionGraphicsItem
                 }
 
                 // Render lines
-                path.lineTo(line1.p2());
+                lineToWithHops(path, line1.p2(), hops);
                 // Render the arc if there is no junction
                 if (!hasJunction && !point.is_junction()) {
                     path.quadTo(point.toPointF(), line2.p2());
                 }
-                path.lineTo(line2.p2());
+                lineToWithHops(path, line2.p2(), hops);
             }
         }
         painter->drawPath(path);
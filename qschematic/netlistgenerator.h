@@ -5,6 +5,8 @@
 #include "items/wirenet.h"
 #include "items/node.h"
 
+#include <QSet>
+
 namespace QSchematic
 {
     class Wire;
@@ -43,6 +45,7 @@ namespace QSchematic
 
             // Create a list of global nets (WireNets that share the same net name)
             std::vector<GlobalNet> globalNets;
+            QSet<QString> globalNetNames;
             unsigned anonNetCounter = 0;
             for (const auto& net : scene.wire_manager()->nets()) {
 
@@ -52,32 +55,27 @@ namespace QSchematic
                 if (!wireNet)
                     continue;
 
-                // Figure out whether we need a new global net
-                bool createNewNet = true;
-                for (auto& globalNet : globalNets) {
-                    if (wireNet->name().isEmpty()) {
-                        createNewNet = true;
-                        break;
-                    }
-                    if (QString::compare(globalNet.name, wireNet->name(), Qt::CaseSensitive) == 0) {
-                        globalNet.wireNets.append(wireNet);
-                        createNewNet = false;
-                        break;
-                    }
-                }
-
-                // Create a new net if supposed to
-                if (createNewNet) {
+                // Every unnamed net is a global net of its own
+                if (wireNet->name().isEmpty()) {
                     GlobalNet newGlobalNet;
                     newGlobalNet.wireNets.append(wireNet);
-                    newGlobalNet.name = wireNet->name();
+                    newGlobalNet.name = QString("N%1").arg(anonNetCounter++, 3, 10, QChar('0'));
+                    globalNets.push_back(newGlobalNet);
+                    continue;
+                }
 
-                    // Prevent empty names
-                    if (newGlobalNet.name.isEmpty())
-                        newGlobalNet.name = QString("N%1").arg(anonNetCounter++, 3, 10, QChar('0'));
+                // The named nets are grouped the first time their name comes up
+                if (globalNetNames.contains(wireNet->name()))
+                    continue;
+                globalNetNames.insert(wireNet->name());
 
-                    globalNets.push_back(newGlobalNet);
+                GlobalNet newGlobalNet;
+                newGlobalNet.name = wireNet->name();
+                for (const auto& namedNet : scene.wire_manager()->nets_named(wireNet->name())) {
+                    if (auto namedWireNet = std::dynamic_pointer_cast<WireNet>(namedNet))
+                        newGlobalNet.wireNets.append(namedWireNet);
                 }
+                globalNets.push_back(newGlobalNet);
             }
 
             // Export nets
@@ -5,6 +5,7 @@
 #include <QGraphicsProxyWidget>
 #include <QUndoStack>
 #include <QMimeData>
+#include <QStyleOptionGraphicsItem>
 #include <QtMath>
 #include <QTimer>
 
@@ -22,22 +23,69 @@
 
 using namespace QSchematic;
 
+// The largest side of the picture of the selection dragged with ghostDragging, larger
+// selections are drawn at a lower resolution
+const qreal GHOST_MAX_SIZE   = 4096;
+const qreal GHOST_OPACITY    = 0.5;
+const qreal GHOST_Z_VALUE    = 100;
+
+namespace
+{
+    void paintItemTree(QPainter& painter, QGraphicsItem& item, const QTransform& transform)
+    {
+        if (!item.isVisible()) {
+            return;
+        }
+
+        // Some items such as proxy widgets need the exposed area
+        QStyleOptionGraphicsItem option;
+        option.exposedRect = item.boundingRect();
+
+        painter.save();
+        painter.setWorldTransform(item.sceneTransform() * transform);
+        item.paint(&painter, &option, nullptr);
+        painter.restore();
+
+        for (QGraphicsItem* child : item.childItems()) {
+            if (child) {
+                paintItemTree(painter, *child, transform);
+            }
+        }
+    }
+
+    /**
+     * Removes the entry at the position of the list by moving the last entry there
+     * \return The entry that was moved, nullptr if the last entry was removed
+     */
+    template<typename T>
+    const Item* takeRegistered(QList<std::shared_ptr<T>>& list, int position)
+    {
+        if (position < list.count() - 1) {
+            list[position] = std::move(list.last());
+            list.removeLast();
+            return list.at(position).get();
+        }
+
+        list.removeLast();
+        return nullptr;
+    }
+}
+
 Scene::Scene(QObject* parent) :
     QGraphicsScene(parent),
     _mode(NormalMode),
     _newWireSegment(false),
     _invertWirePosture(true),
     _movingNodes(false),
+    _itemsAdded(0),
     _highlightedItem(nullptr)
 {
-    // NOTE: still needed, BSP-indexer still crashes on a scene load when
-    // the scene is already populated
-    setItemIndexMethod(ItemIndexMethod::NoIndex);
-
     // Wire system
     m_wire_manager = std::make_shared<wire_system::manager>();
     m_wire_manager->set_net_factory([=] { return std::make_shared<WireNet>(); });
     connect(m_wire_manager.get(), &wire_system::manager::wire_point_moved, this, &Scene::wirePointMoved);
+    connect(m_wire_manager.get(), &wire_system::manager::crossings_changed, this, &Scene::wireCrossingsChanged);
+    connect(m_wire_manager.get(), &wire_system::manager::crossings_outdated, this, &Scene::updateWireCrossings, Qt::QueuedConnection);
 
     // Undo stack
     _undoStack = new QUndoStack(this);
@@ -187,6 +235,11 @@ void Scene::setSettings(const Settings& settings)
     // Store new settings
     _settings = settings;
 
+    // The hops are painted from the cached crossings
+    if (_settings.showWireHops) {
+        m_wire_manager->update_crossings();
+    }
+
     // Redraw
     renderCachedBackground();
     update();
@@ -213,6 +266,7 @@ void Scene::setMode(int mode)
             _newWire->simplify();
         }
         _newWire.reset();
+        _newWireAnchors.clear();
         break;
 
     default:
@@ -257,6 +311,7 @@ void Scene::clearIsDirty()
 void Scene::clear()
 {
     // Ensure no lingering lifespans kept in map-keys, selections or undocommands
+    endGhostDrag();
     _initialItemPositions.clear();
     clearSelection();
     clearFocus();
@@ -303,6 +358,29 @@ bool Scene::addItem(const std::shared_ptr<Item>& item)
 
     // Store the shared pointer to keep the item alive for the QGraphicsScene
     _items << item;
+    registerItem(item);
+
+    // Keep track of the selection
+    _itemRanks.insert(item.get(), _itemsAdded++);
+    connect(item.get(), &Item::selectedChanged, this, &Scene::itemSelectedChanged);
+    if (item->isSelected()) {
+        itemSelectedChanged(*item, true);
+    }
+
+    // Route the new wires around the nodes
+    if (auto node = std::dynamic_pointer_cast<Node>(item)) {
+        auto update = [this, node = node.get()] { updateNodeObstacle(*node); };
+        connect(node.get(), &Item::movedInScene, this, update);
+        connect(node.get(), &Item::rotated, this, update);
+        connect(node.get(), &RectItem::sizeChanged, this, update);
+        updateNodeObstacle(*node);
+
+        // Keep track of the connectors
+        connect(node.get(), &Node::connectorAdded, this, [this, node = node.get()](const std::shared_ptr<Connector>& connector) {
+            registerConnector(node, connector);
+        });
+        connect(node.get(), &Node::connectorRemoved, this, &Scene::unregisterConnector);
+    }
 
     // Let the world know
     emit itemAdded(item);
@@ -326,8 +404,26 @@ bool Scene::removeItem(const std::shared_ptr<Item> item)
     // Remove from scene (if necessary)
     QGraphicsScene::removeItem(item.get());
 
+    // Stop routing around the node and keeping track of its connectors
+    if (auto node = std::dynamic_pointer_cast<Node>(item)) {
+        disconnect(node.get(), &Item::movedInScene, this, nullptr);
+        disconnect(node.get(), &Item::rotated, this, nullptr);
+        disconnect(node.get(), &RectItem::sizeChanged, this, nullptr);
+        disconnect(node.get(), &Node::connectorAdded, this, nullptr);
+        disconnect(node.get(), &Node::connectorRemoved, this, &Scene::unregisterConnector);
+        m_wire_manager->remove_obstacle(node.get());
+    }
+
     // Remove shared pointer from local list to reduce instance count
     _items.removeAll(item);
+    unregisterItem(item);
+
+    // Forget about its selection
+    disconnect(item.get(), &Item::selectedChanged, this, &Scene::itemSelectedChanged);
+    if (auto it = _itemRanks.find(item.get()); it != _itemRanks.end()) {
+        _selectedItems.erase(*it);
+        _itemRanks.erase(it);
+    }
 
     // Update the corresponding scene area (redraw)
     update(itemBoundsToUpdate);
@@ -343,7 +439,7 @@ bool Scene::removeItem(const std::shared_ptr<Item> item)
     return true;
 }
 
-QList<std::shared_ptr<Item>> Scene::items() const
+const QList<std::shared_ptr<Item>>& Scene::items() const
 {
     return _items;
 }
@@ -353,19 +449,16 @@ QList<std::shared_ptr<Item>> Scene::itemsAt(const QPointF &scenePos, Qt::SortOrd
     return ItemUtils::mapItemListToSharedPtrList<QList>(QGraphicsScene::items(scenePos, Qt::IntersectsItemShape, order));
 }
 
-QList<std::shared_ptr<Item>> Scene::items(int itemType) const
+const QList<std::shared_ptr<Item>>& Scene::items(int itemType) const
 {
-    QList<std::shared_ptr<Item>> items;
+    static const QList<std::shared_ptr<Item>> none;
 
-    for (auto& item : _items) {
-        if (item->type() != itemType) {
-            continue;
-        }
-
-        items << item;
+    auto it = _itemsByType.constFind(itemType);
+    if (it == _itemsByType.constEnd()) {
+        return none;
     }
 
-    return items;
+    return *it;
 }
 
 std::vector<std::shared_ptr<Item>> Scene::selectedItems() const
@@ -407,46 +500,55 @@ std::vector<std::shared_ptr<Item>> Scene::selectedItems() const
  */
 std::vector<std::shared_ptr<Item>> Scene::selectedTopLevelItems() const
 {
-    const auto& rawItems = QGraphicsScene::selectedItems();
     std::vector<std::shared_ptr<Item>> items;
+    items.reserve(_selectedItems.size());
 
-    for (auto& item : _items) {
-        if (rawItems.contains(item.get())) {
-            items.push_back(item);
-        }
+    for (const auto& [rank, item] : _selectedItems) {
+        items.push_back(item);
     }
 
     return items;
 }
 
-QList<std::shared_ptr<Node>> Scene::nodes() const
+/**
+ * Returns the top-level nodes. Like the other registries of the types, the order is only
+ * the one in which they were added until an item is removed, which moves the last one in
+ * its place.
+ */
+const QList<std::shared_ptr<Node>>& Scene::nodes() const
 {
-    QList<std::shared_ptr<Node>> nodes;
-
-    for (auto& item : _items) {
-        auto node = std::dynamic_pointer_cast<Node>(item);
-        if (!node) {
-            continue;
-        }
+    return _nodes;
+}
 
-        nodes << node;
-    }
+const QList<std::shared_ptr<Wire>>& Scene::wires() const
+{
+    return _wires;
+}
 
-    return nodes;
+const QList<std::shared_ptr<Label>>& Scene::labels() const
+{
+    return _labels;
 }
 
 std::shared_ptr<Node> Scene::nodeFromConnector(const QSchematic::Connector& connector) const
 {
-    for (auto node : nodes()) {
-        const auto& connectors = node->connectors();
-        auto it = std::find_if(std::cbegin(connectors), std::cend(connectors), [&connector](const auto& c) {
-            return c.get() == &connector;
-        });
-        if (it != std::cend(connectors))
-            return node;
+    Node* node = _connectorNodes.value(&connector, nullptr);
+    if (!node) {
+        return nullptr;
     }
 
-    return nullptr;
+    return node->sharedPtr<Node>();
+}
+
+/**
+ * Returns whether the connector belongs to a selected node, in which case it is moved
+ * along with the selection
+ */
+bool Scene::connectorMovesWithSelection(const wire_system::connectable* connector) const
+{
+    const Node* node = _connectorNodes.value(connector, nullptr);
+
+    return node && node->isSelected();
 }
 
 void Scene::undo()
@@ -546,19 +648,17 @@ void Scene::mousePressEvent(QGraphicsSceneMouseEvent* event)
 
             // Attach point to connector if needed
             bool wireAttached = false;
-            for (const auto& node: nodes()) {
-                for (const auto& connector: node->connectors()) {
-                    // Ignore hidden connectors
-                    if (!connector->isVisible())
-                        continue;
+            for (const wire_system::connectable* connectable : m_wire_manager->connectors_at(snappedPos)) {
+                const auto* connector = static_cast<const Connector*>(connectable);
 
-                    if (QVector2D(connector->scenePos() - snappedPos).length() < 1) {
-                        m_wire_manager->attach_wire_to_connector(_newWire.get(), _newWire->pointsAbsolute().indexOf(snappedPos),
-                                                                 connector.get());
-                        wireAttached = true;
-                        break;
-                    }
-                }
+                // Ignore hidden connectors
+                if (!connector->isVisible())
+                    continue;
+
+                m_wire_manager->attach_wire_to_connector(_newWire.get(), _newWire->pointsAbsolute().indexOf(snappedPos),
+                                                         connector);
+                wireAttached = true;
+                break;
             }
 
             // Attach point to wire if needed
@@ -628,21 +728,38 @@ void Scene::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
             bool needsToMove = false;
             QVector<QVector2D> moveByList;
 
+            // When they're re-routed, the wires only follow the connectors to where they end up
+            const bool batch = _settings.rerouteAttachedWires;
+            if (batch) {
+                m_wire_manager->begin_batch();
+            }
+
             for (const auto& item : itemsToMove) {
-                // Move the item if it is movable and it was previously registered by the mousePressEvent
-                QVector2D moveBy(item->pos() - _initialItemPositions.value(item));
-                // Move the item to its initial position
-                item->setPos(_initialItemPositions.value(item));
+                QVector2D moveBy;
+                if (_dragGhost) {
+                    // Only the picture of the item was moved
+                    moveBy = itemsMoveSnap(item, _dragGhostMoveBy);
+                } else {
+                    // Move the item if it is movable and it was previously registered by the mousePressEvent
+                    moveBy = QVector2D(item->pos() - _initialItemPositions.value(item));
+                    // Move the item to its initial position
+                    item->setPos(_initialItemPositions.value(item));
+                }
                 // Add the moveBy to the list
                 moveByList << moveBy;
                 if (!moveBy.isNull()) {
                     needsToMove = true;
                 }
             }
+            endGhostDrag();
             // Apply the translation
             if (needsToMove) {
                 _undoStack->push(new CommandItemMove(itemsToMove, moveByList));
             }
+            if (batch) {
+                m_wire_manager->commit();
+            }
+            m_wire_manager->clear_reroute_cache();
             for (const auto& item : itemsToMove) {
                 const Node* node = dynamic_cast<const Node*>(item.get());
                 if (node) {
@@ -650,14 +767,10 @@ void Scene::mouseReleaseEvent(QGraphicsSceneMouseEvent* event)
                 }
             }
 
-            for (auto& item : m_wire_manager->wires()) {
-                Wire* wire = dynamic_cast<Wire*>(item.get());
-                if (wire) {
-//                    wire->updatePosition();
-                    wire->simplify();
-                }
-            }
+            // Simplify the wires that changed
+            m_wire_manager->simplify_changed_wires();
         }
+        endGhostDrag();
         break;
     }
 
@@ -728,36 +841,67 @@ void Scene::updateNodeConnections(const Node* node) const
     }
 }
 
-void Scene::wirePointMoved(wire& rawWire, int index)
+/**
+ * Searches the crossings of the wires that changed. This is queued so that it happens once
+ * after the wires have been modified and not while they're being painted.
+ */
+void Scene::updateWireCrossings()
 {
-    // Detach from connector
-    for (const auto& node: nodes()) {
-        for (const auto& connector: node->connectors()) {
-            const wire* wire = m_wire_manager->attached_wire(connector.get());
-            if (!wire) {
-                continue;
-            }
+    if (!_settings.showWireHops) {
+        return;
+    }
 
-            if (wire != &rawWire) {
-                continue;
-            }
+    m_wire_manager->update_crossings();
+}
 
-            if (m_wire_manager->attached_point(connector.get()) == index) {
-                if (connector->scenePos().toPoint() != rawWire.points().at(index).toPoint()) {
-                    m_wire_manager->detach_wire(connector.get());
-                }
+/**
+ * Repaints a wire whose hops changed because it or other wires were moved
+ */
+void Scene::wireCrossingsChanged(wire& rawWire)
+{
+    if (!_settings.showWireHops) {
+        return;
+    }
+
+    if (auto* wire = dynamic_cast<Wire*>(&rawWire)) {
+        wire->QGraphicsObject::update();
+    }
+}
+
+/**
+ * Updates the selected top-level items
+ */
+void Scene::itemSelectedChanged(Item& item, bool isSelected)
+{
+    auto it = _itemRanks.constFind(&item);
+    if (it == _itemRanks.constEnd()) {
+        return;
+    }
+
+    if (isSelected) {
+        _selectedItems.emplace(*it, item.sharedPtr());
+    } else {
+        _selectedItems.erase(*it);
+    }
+}
+
+void Scene::wirePointMoved(wire& rawWire, int index)
+{
+    const QPointF position = rawWire.points().at(index).toPointF();
+
+    // Detach from connector (copy the list as detaching modifies it)
+    const auto attached = m_wire_manager->attached_connectors(&rawWire);
+    for (const wire_system::connectable* connector : attached) {
+        if (m_wire_manager->attached_point(connector) == index) {
+            if (connector->position().toPoint() != position.toPoint()) {
+                m_wire_manager->detach_wire(connector);
             }
         }
     }
 
     // Attach to connector
-    point point = rawWire.points().at(index);
-    for (const auto& node: nodes()) {
-        for (const auto& connector: node->connectors()) {
-            if (connector->scenePos().toPoint() == point.toPoint()) {
-                m_wire_manager->attach_wire_to_connector(&rawWire, index, connector.get());
-            }
-        }
+    for (const wire_system::connectable* connector : m_wire_manager->connectors_at(position)) {
+        m_wire_manager->attach_wire_to_connector(&rawWire, index, connector);
     }
 }
 
@@ -779,7 +923,15 @@ void Scene::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
         // Move, resize or rotate if supposed to
         if (event->buttons() & Qt::LeftButton) {
             // Move all selected items
-            if (_movingNodes) {
+            // Drag a picture of the selection, the items are moved once they are dropped
+            if (_movingNodes && _settings.ghostDragging && !_dragGhost) {
+                beginGhostDrag();
+            }
+            if (_movingNodes && _dragGhost) {
+                _dragGhostMoveBy = _settings.snapToGrid(QVector2D(newMousePos - _initialCursorPosition));
+                _dragGhost->setPos(_dragGhostOrigin + _dragGhostMoveBy.toPointF());
+            }
+            else if (_movingNodes) {
                 QVector<std::shared_ptr<Item>> wiresToMove;
                 QVector<std::shared_ptr<Item>> itemsToMove;
                 for (const auto& item : selectedTopLevelItems()) {
@@ -793,6 +945,12 @@ void Scene::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
                     }
                 }
                 itemsToMove = wiresToMove << itemsToMove;
+
+                // The re-routed wires follow the connectors once all the items have been moved
+                const bool batch = _settings.rerouteAttachedWires;
+                if (batch) {
+                    m_wire_manager->begin_batch();
+                }
                 for (const auto& item : itemsToMove) {
                     // Calculate by how much the item was moved
                     QPointF moveBy = _initialItemPositions.value(item) + newMousePos - _initialCursorPosition - item->pos();
@@ -800,10 +958,11 @@ void Scene::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
                     moveBy = itemsMoveSnap(item, QVector2D(moveBy)).toPointF();
                     item->setPos(item->pos() + moveBy);
                 }
-                // Simplify all the wires
-                for (auto& wire : m_wire_manager->wires()) {
-                    wire->simplify();
+                if (batch) {
+                    m_wire_manager->commit();
                 }
+                // Simplify the wires that changed
+                m_wire_manager->simplify_changed_wires();
             }
             else {
                 QGraphicsScene::mouseMoveEvent(event);
@@ -857,7 +1016,18 @@ void Scene::mouseMoveEvent(QGraphicsSceneMouseEvent* event)
         const QPointF& snappedPos = _settings.snapToGrid(event->scenePos());
 
         // Add a new wire segment. Only allow straight angles (if supposed to)
-        if (_settings.routeStraightAngles) {
+        if (_settings.routeStraightAngles && _settings.routeAroundObstacles) {
+            if (_newWireSegment) {
+                // Remove the last point if there was a previous segment
+                if (_newWire->pointsRelative().count() > 1) {
+                    _newWire->removeLastPoint();
+                }
+                _newWireAnchors << _newWire->pointsAbsolute().count() - 1;
+                _newWireSegment = false;
+            }
+
+            routeNewWire(snappedPos);
+        } else if (_settings.routeStraightAngles) {
             if (_newWireSegment) {
                 // Remove the last point if there was a previous segment
                 if (_newWire->pointsRelative().count() > 1) {
@@ -1105,10 +1275,19 @@ void Scene::setupNewItem(Item& item)
 
 void Scene::generateConnections()
 {
-    for (const auto& connector : connectors()) {
-        std::shared_ptr<wire> wire = m_wire_manager->wire_with_extremity_at(connector->scenePos());
-        if (wire) {
-            m_wire_manager->attach_wire_to_connector(wire.get(), connector.get());
+    // The wires are searched on several threads so the positions have to be known beforehand
+    const auto connectorsList = connectors();
+    QVector<QPointF> positions;
+    positions.reserve(connectorsList.count());
+    for (const auto& connector : connectorsList) {
+        positions.append(connector->scenePos());
+    }
+
+    // Attach them in order
+    const auto wires = m_wire_manager->wires_with_extremity_at(positions);
+    for (int i = 0; i < connectorsList.count(); i++) {
+        if (auto* wire = wires.at(i)) {
+            m_wire_manager->attach_wire_to_connector(wire, connectorsList.at(i).get());
         }
     }
 }
@@ -1127,6 +1306,199 @@ void Scene::finishCurrentWire()
     _newWire->simplify();
 //    _newWire->updatePosition();
     _newWire.reset();
+    _newWireAnchors.clear();
+}
+
+/**
+ * Replaces the points of the new wire that follow the last point that has been placed
+ * by a path to the given position that goes around the nodes and doesn't run along the
+ * other wires. Falls back to a single straight angle if there's no such path.
+ */
+void Scene::routeNewWire(const QPointF& to)
+{
+    if (!_newWire || _newWireAnchors.isEmpty()) {
+        return;
+    }
+
+    // Remove the previous path
+    const int anchor = _newWireAnchors.last();
+    while (_newWire->pointsAbsolute().count() > anchor + 1) {
+        _newWire->removeLastPoint();
+    }
+
+    const QPointF from = _newWire->pointsAbsolute().at(anchor);
+    const QVector<QPointF> path = m_wire_manager->route(from, to, _newWire.get());
+    if (!path.isEmpty()) {
+        for (const QPointF& point : path) {
+            _newWire->append_point(point);
+        }
+        return;
+    }
+
+    // Create the intermediate point that creates the straight angle
+    QPointF corner(from.x(), to.y());
+    if (_invertWirePosture) {
+        corner.setX(to.x());
+        corner.setY(from.y());
+    }
+    _newWire->append_point(corner);
+    _newWire->append_point(to);
+}
+
+/**
+ * Updates the area of the node that the routed wires go around
+ */
+void Scene::updateNodeObstacle(const Node& node) const
+{
+    m_wire_manager->set_obstacle(&node, node.mapRectToScene(node.sizeRect()));
+}
+
+/**
+ * Replaces the movable selected items by a picture of them that is dragged instead. This
+ * way only a single item moves while dragging and the items, their wires and the wire
+ * system are updated once when the items are dropped.
+ */
+void Scene::beginGhostDrag()
+{
+    // The area covered by the items
+    QVector<std::shared_ptr<Item>> items;
+    QRectF rect;
+    for (const auto& item : selectedTopLevelItems()) {
+        if (item->isMovable() && _initialItemPositions.contains(item)) {
+            items << item;
+            rect |= item->sceneBoundingRect() | item->mapRectToScene(item->childrenBoundingRect());
+        }
+    }
+    if (items.isEmpty() || rect.isEmpty()) {
+        return;
+    }
+
+    // Render them, they haven't moved yet
+    const qreal scale = qMin(1.0, GHOST_MAX_SIZE / qMax(rect.width(), rect.height()));
+    QPixmap pixmap(QSizeF(rect.size() * scale).toSize().expandedTo(QSize(1, 1)));
+    pixmap.fill(Qt::transparent);
+    {
+        QPainter painter(&pixmap);
+        painter.setRenderHint(QPainter::Antialiasing, _settings.antialiasing);
+        painter.setRenderHint(QPainter::TextAntialiasing, _settings.antialiasing);
+        painter.setOpacity(GHOST_OPACITY);
+
+        const QTransform transform = QTransform::fromScale(scale, scale).translate(-rect.left(), -rect.top());
+        for (const auto& item : items) {
+            paintItemTree(painter, *item, transform);
+        }
+    }
+
+    _dragGhost = std::make_unique<QGraphicsPixmapItem>(pixmap);
+    _dragGhost->setScale(1 / scale);
+    _dragGhost->setZValue(GHOST_Z_VALUE);
+    _dragGhost->setPos(rect.topLeft());
+    _dragGhostOrigin = rect.topLeft();
+    _dragGhostMoveBy = QVector2D();
+    QGraphicsScene::addItem(_dragGhost.get());
+}
+
+void Scene::endGhostDrag()
+{
+    if (!_dragGhost) {
+        return;
+    }
+
+    QGraphicsScene::removeItem(_dragGhost.get());
+    _dragGhost.reset();
+}
+
+/**
+ * Adds a top-level item to the registry of its type
+ */
+void Scene::registerItem(const std::shared_ptr<Item>& item)
+{
+    auto& itemsOfType = _itemsByType[item->type()];
+    RegistryPosition position { static_cast<int>(itemsOfType.count()), -1 };
+    itemsOfType << item;
+
+    if (auto node = std::dynamic_pointer_cast<Node>(item)) {
+        position.inClass = _nodes.count();
+        _nodes << node;
+        for (const auto& connector : node->connectors()) {
+            registerConnector(node.get(), connector);
+        }
+    } else if (auto wire = std::dynamic_pointer_cast<Wire>(item)) {
+        position.inClass = _wires.count();
+        _wires << wire;
+    } else if (auto label = std::dynamic_pointer_cast<Label>(item)) {
+        position.inClass = _labels.count();
+        _labels << label;
+    }
+
+    _registryPositions.insert(item.get(), position);
+}
+
+/**
+ * Removes a top-level item from the registry of its type. The last item of each list it
+ * was in takes its place so that it doesn't need to be searched.
+ */
+void Scene::unregisterItem(const std::shared_ptr<Item>& item)
+{
+    auto positionIt = _registryPositions.find(item.get());
+    if (positionIt == _registryPositions.end()) {
+        return;
+    }
+    const RegistryPosition position = *positionIt;
+    _registryPositions.erase(positionIt);
+
+    auto it = _itemsByType.find(item->type());
+    if (it != _itemsByType.end()) {
+        if (const Item* moved = takeRegistered(*it, position.inType)) {
+            _registryPositions[moved].inType = position.inType;
+        }
+        if (it->isEmpty()) {
+            _itemsByType.erase(it);
+        }
+    }
+
+    const Item* moved = nullptr;
+    if (auto node = std::dynamic_pointer_cast<Node>(item)) {
+        moved = takeRegistered(_nodes, position.inClass);
+
+        // Remove all of its connectors in a single pass
+        const Node* raw = node.get();
+        _connectors.erase(std::remove_if(_connectors.begin(), _connectors.end(), [this, raw](const auto& connector) {
+            return _connectorNodes.value(connector.get(), nullptr) == raw;
+        }), _connectors.end());
+        for (const auto& connector : node->connectors()) {
+            _connectorNodes.remove(connector.get());
+            m_wire_manager->remove_connector(connector.get());
+        }
+    } else if (std::dynamic_pointer_cast<Wire>(item)) {
+        moved = takeRegistered(_wires, position.inClass);
+    } else if (std::dynamic_pointer_cast<Label>(item)) {
+        moved = takeRegistered(_labels, position.inClass);
+    }
+    if (moved) {
+        _registryPositions[moved].inClass = position.inClass;
+    }
+}
+
+void Scene::registerConnector(Node* node, const std::shared_ptr<Connector>& connector)
+{
+    if (!connector || _connectorNodes.contains(connector.get())) {
+        return;
+    }
+
+    _connectors << connector;
+    _connectorNodes.insert(connector.get(), node);
+    m_wire_manager->add_connector(connector.get());
+}
+
+void Scene::unregisterConnector(const std::shared_ptr<Connector>& connector)
+{
+    if (!connector || !_connectorNodes.remove(connector.get())) {
+        return;
+    }
+
+    _connectors.removeAll(connector);
+    m_wire_manager->remove_connector(connector.get());
 }
 
 std::shared_ptr<Wire>
@@ -1149,15 +1521,12 @@ QList<QPointF> Scene::connectionPoints() const
     return list;
 }
 
-QList<std::shared_ptr<Connector>> Scene::connectors() const
+/**
+ * Returns the connectors of all the nodes
+ */
+const QList<std::shared_ptr<Connector>>& Scene::connectors() const
 {
-    QList<std::shared_ptr<Connector>> list;
-
-    for (const auto& node : nodes()) {
-        list << node->connectors();
-    }
-
-    return list;
+    return _connectors;
 }
 
 void Scene::itemHoverEnter(const std::shared_ptr<const Item>& item)
@@ -1189,8 +1558,19 @@ void Scene::removeLastWirePoint()
         return;
     }
 
+    // If the wire is routed around obstacles, the path from the previous point is recomputed
+    if (_settings.routeStraightAngles && _settings.routeAroundObstacles) {
+        // Do nothing if no point has been placed after the first one
+        if (_newWireAnchors.count() > 1) {
+            // Keep the position of the last point
+            QPointF mousePos = _newWire->pointsAbsolute().last();
+            _newWireAnchors.removeLast();
+            routeNewWire(mousePos);
+        }
+    }
+
     // If we're supposed to preseve right angles, two points have to be removed
-    if (_settings.routeStraightAngles) {
+    else if (_settings.routeStraightAngles) {
         // Do nothing if there are not at least 4 points
         if (_newWire->pointsAbsolute().count() > 3) {
             // Keep the position of the last point
@@ -1304,4 +1684,49 @@ bool Scene::removeWire(const std::shared_ptr<Wire>& wire)
     return m_wire_manager->remove_wire(wire);
 }
 
+/**
+ * Creates the wires of several connections at once. The wires go around the nodes and
+ * don't run along the existing wires nor along each other. Their paths are searched on
+ * worker threads and they're added as a single undo command.
+ * \param report Receives the statistics of the routing if not nullptr
+ * \return The wire of each connection or nullptr if no path was found
+ */
+QVector<std::shared_ptr<Wire>> Scene::routeConnections(const QVector<QPair<std::shared_ptr<Connector>, std::shared_ptr<Connector>>>& connections,
+                                                       wire_system::routing_report* report)
+{
+    QVector<QPair<QPointF, QPointF>> ends;
+    ends.reserve(connections.count());
+    for (const auto& connection : connections) {
+        ends.append({ connection.first->scenePos(), connection.second->scenePos() });
+    }
+    const auto paths = m_wire_manager->route_all(ends, report);
+
+    QVector<std::shared_ptr<Wire>> wires(connections.count());
+    _undoStack->beginMacro(tr("Route connections"));
+    m_wire_manager->begin_batch();
+    for (int i = 0; i < connections.count(); i++) {
+        if (paths.at(i).isEmpty()) {
+            continue;
+        }
+
+        auto wire = make_wire();
+        wire->setPos(ends.at(i).first);
+        wire->append_point(ends.at(i).first);
+        for (const QPointF& point : paths.at(i)) {
+            wire->append_point(point);
+        }
+        wire->setAcceptHoverEvents(true);
+        wire->setFlag(QGraphicsItem::ItemIsSelectable, true);
+        _undoStack->push(new CommandItemAdd(this, wire));
+
+        m_wire_manager->attach_wire_to_connector(wire.get(), 0, connections.at(i).first.get());
+        m_wire_manager->attach_wire_to_connector(wire.get(), wire->pointsAbsolute().count() - 1, connections.at(i).second.get());
+        wires[i] = wire;
+    }
+    m_wire_manager->commit();
+    _undoStack->endMacro();
+
+    return wires;
+}
+
 
@@ -7,17 +7,23 @@
 //#include "utils/itemscustodian.h"
 
 #include <gpds/serialize.hpp>
+#include <QGraphicsPixmapItem>
 #include <QGraphicsScene>
+#include <QHash>
 #include <QUndoStack>
+#include <QVector2D>
 
 #include <algorithm>
 #include <memory>
 #include <functional>
+#include <map>
+#include <type_traits>
 
 namespace QSchematic {
 
     class Node;
     class Connector;
+    class Label;
     class WireNet;
 
     class Scene :
@@ -54,8 +60,8 @@ namespace QSchematic {
         void clear();
         bool addItem(const std::shared_ptr<Item>& item);
         bool removeItem(const std::shared_ptr<Item> item);
-        QList<std::shared_ptr<Item>> items() const;
-        QList<std::shared_ptr<Item>> items(int itemType) const;
+        const QList<std::shared_ptr<Item>>& items() const;
+        const QList<std::shared_ptr<Item>>& items(int itemType) const;
 
         /**
          * Get list of items of a certain type.
@@ -67,25 +73,40 @@ namespace QSchematic {
         [[nodiscard]]
         std::vector<std::shared_ptr<T>> items() const
         {
-            const auto& itms = items();
-
-            std::vector<std::shared_ptr<T>> ret;
-            ret.reserve(itms.size());
-
-            for (const auto& item : itms)
-                if (auto casted = std::dynamic_pointer_cast<T>(item); casted)
-                    ret.emplace_back(std::move(casted));
-
-            return ret;
+            // Use the registries of the built-in types
+            if constexpr (std::is_same_v<T, Node>) {
+                return { _nodes.cbegin(), _nodes.cend() };
+            }
+            else if constexpr (std::is_same_v<T, Wire>) {
+                return { _wires.cbegin(), _wires.cend() };
+            }
+            else if constexpr (std::is_same_v<T, Label>) {
+                return { _labels.cbegin(), _labels.cend() };
+            }
+            else {
+                const auto& itms = items();
+
+                std::vector<std::shared_ptr<T>> ret;
+                ret.reserve(itms.size());
+
+                for (const auto& item : itms)
+                    if (auto casted = std::dynamic_pointer_cast<T>(item); casted)
+                        ret.emplace_back(std::move(casted));
+
+                return ret;
+            }
         }
 
         QList<std::shared_ptr<Item>> itemsAt(const QPointF& scenePos, Qt::SortOrder order = Qt::DescendingOrder) const;
         std::vector<std::shared_ptr<Item>> selectedItems() const;
         std::vector<std::shared_ptr<Item>> selectedTopLevelItems() const;
-        QList<std::shared_ptr<Node>> nodes() const;
+        const QList<std::shared_ptr<Node>>& nodes() const;
+        [[nodiscard]] const QList<std::shared_ptr<Wire>>& wires() const;
+        [[nodiscard]] const QList<std::shared_ptr<Label>>& labels() const;
         [[nodiscard]] std::shared_ptr<Node> nodeFromConnector(const QSchematic::Connector& connector) const;
+        [[nodiscard]] bool connectorMovesWithSelection(const wire_system::connectable* connector) const;
         QList<QPointF> connectionPoints() const;
-        QList<std::shared_ptr<Connector>> connectors() const;
+        const QList<std::shared_ptr<Connector>>& connectors() const;
         std::shared_ptr<wire_system::manager> wire_manager() const;
         void itemHoverEnter(const std::shared_ptr<const Item>& item);
         void itemHoverLeave(const std::shared_ptr<const Item>& item);
@@ -93,6 +114,8 @@ namespace QSchematic {
         void removeUnconnectedWires();
         bool addWire(const std::shared_ptr<Wire>& wire);
         bool removeWire(const std::shared_ptr<Wire>& wire);
+        QVector<std::shared_ptr<Wire>> routeConnections(const QVector<QPair<std::shared_ptr<Connector>, std::shared_ptr<Connector>>>& connections,
+                                                        wire_system::routing_report* report = nullptr);
         QList<std::shared_ptr<WireNet>> nets(const std::shared_ptr<net> wireNet) const;
 
         void undo();
@@ -138,6 +161,14 @@ namespace QSchematic {
         void setupNewItem(Item& item);
         void generateConnections();
         void finishCurrentWire();
+        void routeNewWire(const QPointF& to);
+        void updateNodeObstacle(const Node& node) const;
+        void beginGhostDrag();
+        void endGhostDrag();
+        void registerItem(const std::shared_ptr<Item>& item);
+        void unregisterItem(const std::shared_ptr<Item>& item);
+        void registerConnector(Node* node, const std::shared_ptr<Connector>& connector);
+        void unregisterConnector(const std::shared_ptr<Connector>& connector);
 
         /**
          * Make new wire.
@@ -162,6 +193,36 @@ namespace QSchematic {
          */
         QList<std::shared_ptr<Item>> _items;
 
+        /**
+         * The top-level items by their type and the connectors of the nodes. These are
+         * updated when items are added or removed so that they don't need to be searched.
+         */
+        QList<std::shared_ptr<Node>> _nodes;
+        QList<std::shared_ptr<Wire>> _wires;
+        QList<std::shared_ptr<Label>> _labels;
+        QList<std::shared_ptr<Connector>> _connectors;
+        QHash<const wire_system::connectable*, Node*> _connectorNodes;
+        QHash<int, QList<std::shared_ptr<Item>>> _itemsByType;
+
+        /**
+         * The index of each top-level item in the registry of its type and in the one of
+         * its class, so that it can be removed without searching them.
+         */
+        struct RegistryPosition
+        {
+            int inType;
+            int inClass;            // -1 if it isn't a node, a wire or a label
+        };
+        QHash<const Item*, RegistryPosition> _registryPositions;
+
+        /**
+         * The selected top-level items in the order in which they were added to the scene.
+         * This is updated when the items' selection changes.
+         */
+        std::map<quint64, std::shared_ptr<Item>> _selectedItems;
+        QHash<const Item*, quint64> _itemRanks;     // The key of each top-level item in _selectedItems
+        quint64 _itemsAdded;
+
         // Note: haven't investigated destructor specification, but it seems
         // this can be skipped, although it would be: explicit, more efficient,
         // and possibly required in more complex destruction scenarios — but
@@ -175,11 +236,15 @@ namespace QSchematic {
         int _mode;
         std::shared_ptr<Wire> _newWire;
         bool _newWireSegment;
+        QVector<int> _newWireAnchors;   // The indices of the points that have been placed by clicking when routing around obstacles
         bool _invertWirePosture;
         bool _movingNodes;
         QPointF _lastMousePos;
         QMap<std::shared_ptr<Item>, QPointF> _initialItemPositions;
         QPointF _initialCursorPosition;
+        std::unique_ptr<QGraphicsPixmapItem> _dragGhost;   // Shows the selection being dragged while the items stay in place
+        QPointF _dragGhostOrigin;
+        QVector2D _dragGhostMoveBy;
         QUndoStack* _undoStack;
         std::shared_ptr<wire_system::manager> m_wire_manager;
         Item* _highlightedItem;
@@ -189,6 +254,9 @@ namespace QSchematic {
     private slots:
         void updateNodeConnections(const Node* node) const;
         void wirePointMoved(wire& rawWire, int index);
+        void wireCrossingsChanged(wire& rawWire);
+        void updateWireCrossings();
+        void itemSelectedChanged(Item& item, bool isSelected);
     };
 
 }
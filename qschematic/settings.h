@@ -22,6 +22,10 @@ namespace QSchematic {
         int resizeHandleSize        = 7;
         bool routeStraightAngles    = true;
         bool preserveStraightAngles = true;
+        bool routeAroundObstacles   = false;
+        bool rerouteAttachedWires   = false;
+        bool showWireHops           = false;
+        bool ghostDragging          = false;
         bool antialiasing           = true;
         std::chrono::milliseconds popupDelay{ 400 };
 
@@ -0,0 +1,19 @@
+#define DOCTEST_CONFIG_IMPLEMENT
+#include "../wire_system/test/3rdparty/doctest.h"
+
+#include <QApplication>
+
+int main(int argc, char* argv[])
+{
+    // The items need an application for their fonts. The offscreen platform lets the tests
+    // run without a display.
+    if (qEnvironmentVariableIsEmpty("QT_QPA_PLATFORM")) {
+        qputenv("QT_QPA_PLATFORM", "offscreen");
+    }
+    QApplication application(argc, argv);
+
+    doctest::Context context;
+    context.applyCommandLine(argc, argv);
+
+    return context.run();
+}
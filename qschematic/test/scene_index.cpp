@@ -0,0 +1,331 @@
+#include "../wire_system/test/3rdparty/doctest.h"
+#include "../scene.h"
+#include "../items/label.h"
+#include "../items/node.h"
+#include "../items/connector.h"
+#include "../items/wire.h"
+
+#include <QCoreApplication>
+#include <QGraphicsSceneMouseEvent>
+#include <QUndoStack>
+#include <QGraphicsScene>
+
+#include <chrono>
+
+namespace
+{
+    void send_mouse_event(QGraphicsScene& scene, QEvent::Type type, const QPointF& pos, const QPointF& pressPos)
+    {
+        QGraphicsSceneMouseEvent event(type);
+        event.setScenePos(pos);
+        event.setLastScenePos(pos);
+        event.setButtonDownScenePos(Qt::LeftButton, pressPos);
+        event.setButton(Qt::LeftButton);
+        event.setButtons(type == QEvent::GraphicsSceneMouseRelease ? Qt::NoButton : Qt::LeftButton);
+        QCoreApplication::sendEvent(&scene, &event);
+    }
+
+    void send_hover_event(QGraphicsScene& scene, const QPointF& pos)
+    {
+        QGraphicsSceneMouseEvent event(QEvent::GraphicsSceneMouseMove);
+        event.setScenePos(pos);
+        event.setLastScenePos(pos);
+        event.setButtons(Qt::NoButton);
+        QCoreApplication::sendEvent(&scene, &event);
+    }
+
+    bool scene_has_item_at(const QGraphicsScene& scene, const QPointF& point, const QGraphicsItem* item)
+    {
+        return scene.items(point).contains(const_cast<QGraphicsItem*>(item));
+    }
+}
+
+TEST_SUITE("Scene index")
+{
+    TEST_CASE("The scene is indexed")
+    {
+        QSchematic::Scene scene;
+
+        REQUIRE(scene.itemIndexMethod() == QGraphicsScene::BspTreeIndex);
+    }
+
+    TEST_CASE("Items are found where their bounding rect grew")
+    {
+        QSchematic::Scene scene;
+
+        // A label whose text gets longer
+        auto label = std::make_shared<QSchematic::Label>();
+        label->setText("a");
+        scene.addItem(label);
+        REQUIRE(scene_has_item_at(scene, label->mapToScene(label->textRect().center()), label.get()));
+
+        label->setText("a much longer text than before");
+        const QPointF end = label->mapToScene(label->textRect().topRight() + QPointF(-2, 2));
+        REQUIRE(scene_has_item_at(scene, end, label.get()));
+
+        // A wire whose points are replaced
+        auto wire = std::make_shared<QSchematic::Wire>();
+        wire->append_point({0, 0});
+        wire->append_point({100, 0});
+        scene.addWire(wire);
+        REQUIRE(scene_has_item_at(scene, {50, 0}, wire.get()));
+
+        wire->set_points({ wire_system::point(0, 0), wire_system::point(0, 400) });
+        wire->update();
+        REQUIRE(scene_has_item_at(scene, {0, 300}, wire.get()));
+        REQUIRE_FALSE(scene_has_item_at(scene, {50, 0}, wire.get()));
+    }
+
+    TEST_CASE("Items are registered by their type")
+    {
+        QSchematic::Scene scene;
+
+        auto node = std::make_shared<QSchematic::Node>();
+        auto connector1 = std::make_shared<QSchematic::Connector>();
+        node->addConnector(connector1);
+        auto label = std::make_shared<QSchematic::Label>();
+        auto wire = std::make_shared<QSchematic::Wire>();
+        wire->append_point({0, 0});
+        wire->append_point({100, 0});
+        scene.addItem(node);
+        scene.addItem(label);
+        scene.addWire(wire);
+
+        REQUIRE(scene.items().count() == 3);
+        REQUIRE(scene.nodes().count() == 1);
+        REQUIRE(scene.nodes().first().get() == node.get());
+        REQUIRE(scene.wires().count() == 1);
+        REQUIRE(scene.wires().first().get() == wire.get());
+        REQUIRE(scene.labels().count() == 1);
+        REQUIRE(scene.items(QSchematic::Item::LabelType).count() == 1);
+        REQUIRE(scene.items(QSchematic::Item::ConnectorType).isEmpty());
+        REQUIRE(scene.items<QSchematic::Node>().size() == 1);
+        REQUIRE(scene.connectors().count() == 1);
+        REQUIRE(scene.nodeFromConnector(*connector1).get() == node.get());
+
+        // Connectors added to and removed from a node that is in the scene
+        auto connector2 = std::make_shared<QSchematic::Connector>();
+        node->addConnector(connector2);
+        REQUIRE(scene.connectors().count() == 2);
+        REQUIRE(scene.nodeFromConnector(*connector2).get() == node.get());
+        node->removeConnector(connector1);
+        REQUIRE(scene.connectors().count() == 1);
+        REQUIRE(scene.connectors().first().get() == connector2.get());
+        REQUIRE(scene.nodeFromConnector(*connector1) == nullptr);
+
+        // Removing the items
+        scene.removeItem(node);
+        REQUIRE(scene.nodes().isEmpty());
+        REQUIRE(scene.connectors().isEmpty());
+        REQUIRE(scene.nodeFromConnector(*connector2) == nullptr);
+        scene.removeWire(wire);
+        REQUIRE(scene.wires().isEmpty());
+        scene.removeItem(label);
+        REQUIRE(scene.items(QSchematic::Item::LabelType).isEmpty());
+        REQUIRE(scene.items().isEmpty());
+    }
+
+    TEST_CASE("Items can be removed from anywhere in the registries")
+    {
+        QSchematic::Scene scene;
+
+        QVector<std::shared_ptr<QSchematic::Node>> nodes;
+        for (int i = 0; i < 5; i++) {
+            auto node = std::make_shared<QSchematic::Node>();
+            scene.addItem(node);
+            nodes.append(node);
+        }
+
+        auto contains = [&scene](const std::shared_ptr<QSchematic::Node>& node) {
+            return scene.nodes().contains(node) && scene.items(node->type()).contains(node);
+        };
+
+        // The last node takes the place of the removed one
+        scene.removeItem(nodes.at(1));
+        REQUIRE(scene.nodes().count() == 4);
+        REQUIRE_FALSE(contains(nodes.at(1)));
+        for (int i : { 0, 2, 3, 4 }) {
+            REQUIRE(contains(nodes.at(i)));
+        }
+
+        scene.removeItem(nodes.at(4));
+        scene.removeItem(nodes.at(0));
+        REQUIRE(scene.nodes().count() == 2);
+        REQUIRE(contains(nodes.at(2)));
+        REQUIRE(contains(nodes.at(3)));
+
+        // The removed nodes are no longer tracked
+        nodes.at(1)->addConnector(std::make_shared<QSchematic::Connector>());
+        REQUIRE(scene.connectors().isEmpty());
+
+        scene.removeItem(nodes.at(3));
+        scene.removeItem(nodes.at(2));
+        REQUIRE(scene.nodes().isEmpty());
+        REQUIRE(scene.items(QSchematic::Item::NodeType).isEmpty());
+    }
+
+    TEST_CASE("The selected top-level items are tracked")
+    {
+        QSchematic::Scene scene;
+
+        QVector<std::shared_ptr<QSchematic::Node>> nodes;
+        for (int i = 0; i < 4; i++) {
+            auto node = std::make_shared<QSchematic::Node>();
+            node->setPos(i * 200, 0);
+            scene.addItem(node);
+            nodes.append(node);
+        }
+        auto connector = std::make_shared<QSchematic::Connector>();
+        nodes.first()->addConnector(connector);
+        REQUIRE(scene.selectedTopLevelItems().empty());
+
+        // In the order in which they were added, children are ignored
+        nodes.at(2)->setSelected(true);
+        nodes.at(0)->setSelected(true);
+        connector->setSelected(true);
+        auto selected = scene.selectedTopLevelItems();
+        REQUIRE(selected.size() == 2);
+        REQUIRE(selected.at(0).get() == nodes.at(0).get());
+        REQUIRE(selected.at(1).get() == nodes.at(2).get());
+
+        nodes.at(0)->setSelected(false);
+        selected = scene.selectedTopLevelItems();
+        REQUIRE(selected.size() == 1);
+        REQUIRE(selected.at(0).get() == nodes.at(2).get());
+
+        // Removed items are no longer selected
+        scene.removeItem(nodes.at(2));
+        REQUIRE(scene.selectedTopLevelItems().empty());
+
+        nodes.at(1)->setSelected(true);
+        nodes.at(3)->setSelected(true);
+        scene.clearSelection();
+        REQUIRE(scene.selectedTopLevelItems().empty());
+    }
+
+    TEST_CASE("Moving a wire keeps its ends on the connectors of the nodes that don't move")
+    {
+        QSchematic::Scene scene;
+
+        auto node = std::make_shared<QSchematic::Node>();
+        auto connector = std::make_shared<QSchematic::Connector>();
+        node->addConnector(connector);
+        scene.addItem(node);
+        const QPointF pin = connector->scenePos();
+
+        auto wire = std::make_shared<QSchematic::Wire>();
+        wire->append_point(pin);
+        wire->append_point(pin + QPointF(200, 0));
+        scene.addWire(wire);
+        scene.wire_manager()->attach_wire_to_connector(wire.get(), connector.get());
+        REQUIRE(scene.wire_manager()->attached_connectors(wire.get()).count() == 1);
+        REQUIRE_FALSE(scene.connectorMovesWithSelection(connector.get()));
+
+        // The end on the connector is pulled back
+        wire->setPos(wire->pos() + QPointF(0, 40));
+        REQUIRE(wire->pointsAbsolute().first() == pin);
+        REQUIRE(wire->pointsAbsolute().last() == pin + QPointF(200, 40));
+
+        // Unless the node moves as well
+        node->setSelected(true);
+        REQUIRE(scene.connectorMovesWithSelection(connector.get()));
+        wire->setPos(wire->pos() + QPointF(0, 40));
+        REQUIRE(wire->pointsAbsolute().first() == pin + QPointF(0, 40));
+    }
+
+    TEST_CASE("Benchmark: Dragging 10000 nodes with and without ghost dragging")
+    {
+
+        const int count = 10000;
+        const int moves = 20;
+        double timePerMove[2];
+        for (int ghost = 0; ghost < 2; ghost++) {
+            QSchematic::Scene scene;
+            QSchematic::Settings settings;
+            settings.ghostDragging = ghost == 1;
+            scene.setSettings(settings);
+
+            QVector<std::shared_ptr<QSchematic::Node>> nodes;
+            for (int i = 0; i < count; i++) {
+                auto node = std::make_shared<QSchematic::Node>();
+                node->setPos((i % 100) * 200, (i / 100) * 300);
+                scene.addItem(node);
+                node->setSelected(true);
+                nodes.append(node);
+            }
+
+            // Drag the selection by its first node
+            const QPointF start = nodes.first()->mapToScene(nodes.first()->sizeRect().center());
+            send_mouse_event(scene, QEvent::GraphicsSceneMousePress, start, start);
+            const auto begin = std::chrono::steady_clock::now();
+            for (int m = 1; m <= moves; m++) {
+                send_mouse_event(scene, QEvent::GraphicsSceneMouseMove, start + QPointF(m * 5, m * 3), start);
+            }
+            const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - begin);
+            timePerMove[ghost] = elapsed.count() / moves;
+            send_mouse_event(scene, QEvent::GraphicsSceneMouseRelease, start + QPointF(moves * 5, moves * 3), start);
+
+            // Both end up moving the items by the snapped distance in a single command
+            REQUIRE(nodes.first()->pos() == QPointF(100, 60));
+            REQUIRE(nodes.last()->pos() == QPointF(99 * 200 + 100, 99 * 300 + 60));
+            REQUIRE(scene.undoStack()->count() == 1);
+            REQUIRE(scene.selectedTopLevelItems().size() == count);
+        }
+
+        MESSAGE(count << " nodes: " << timePerMove[0] << " ms per mouse move, " << timePerMove[1] << " ms with ghost dragging");
+    }
+
+    TEST_CASE("Benchmark: Hit testing and hovering on a scene with 10000 nodes and wires")
+    {
+        // A wire below every node, with and without an index
+        const int count = 10000;
+        const int columns = 100;
+        const int queries = 1000;
+        double timePerQuery[2];
+        double timePerHover[2];
+        const QGraphicsScene::ItemIndexMethod methods[2] = { QGraphicsScene::NoIndex, QGraphicsScene::BspTreeIndex };
+        for (int m = 0; m < 2; m++) {
+            QSchematic::Scene scene;
+            scene.setItemIndexMethod(methods[m]);
+
+            QVector<QPointF> points;
+            for (int i = 0; i < count; i++) {
+                const QPointF pos((i % columns) * 200, (i / columns) * 300);
+                auto node = std::make_shared<QSchematic::Node>();
+                node->setPos(pos);
+                scene.addItem(node);
+
+                auto wire = std::make_shared<QSchematic::Wire>();
+                wire->append_point(pos + QPointF(0, 270));
+                wire->append_point(pos + QPointF(160, 270));
+                scene.addWire(wire);
+
+                points << node->mapToScene(node->sizeRect().center()) << pos + QPointF(80, 270);
+            }
+
+            // The index is built on the first query
+            REQUIRE_FALSE(scene.itemsAt(points.first()).isEmpty());
+
+            // Look up the items under the points of the nodes and wires all over the scene
+            auto start = std::chrono::steady_clock::now();
+            int found = 0;
+            for (int q = 0; q < queries; q++) {
+                if (!scene.itemsAt(points.at((q * 7919) % points.count())).isEmpty()) {
+                    found++;
+                }
+            }
+            timePerQuery[m] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / queries;
+            REQUIRE(found == queries);
+
+            // Move the mouse over them, which highlights the item under the cursor
+            start = std::chrono::steady_clock::now();
+            for (int q = 0; q < queries; q++) {
+                send_hover_event(scene, points.at((q * 7919) % points.count()));
+            }
+            timePerHover[m] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / queries;
+        }
+
+        MESSAGE(count << " nodes and wires: " << timePerQuery[0] << " us per itemsAt() and " << timePerHover[0]
+                << " us per hover without an index, " << timePerQuery[1] << " us and " << timePerHover[1] << " us with the BSP tree");
+    }
+}
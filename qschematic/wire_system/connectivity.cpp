@@ -0,0 +1,314 @@
+#include "connectivity.h"
+
+using namespace wire_system;
+
+/**
+ * Adds a wire as a set of its own. Nothing happens if the wire is already known.
+ */
+void connectivity::insert(wire* wire)
+{
+    if (!wire || contains(wire)) {
+        return;
+    }
+
+    const int set = create_set();
+    m_nodes.insert(wire, { set, 0, {}, {} });
+    m_sets[set].append(wire);
+}
+
+/**
+ * Removes the wire and its connections.
+ * \return The parts of the set that were split off because they are no longer connected
+ */
+QVector<QVector<wire*>> connectivity::remove(const wire* wire)
+{
+    auto it = m_nodes.find(wire);
+    if (it == m_nodes.end()) {
+        return {};
+    }
+
+    const node node = it.value();
+    m_nodes.erase(it);
+    take_out(node);
+
+    // Remove the connections
+    QVector<class wire*> neighbors;
+    for (auto* otherWire : node.connected) {
+        m_nodes[otherWire].connected_by.removeAll(const_cast<class wire*>(wire));
+        if (!neighbors.contains(otherWire)) {
+            neighbors.append(otherWire);
+        }
+    }
+    for (auto* otherWire : node.connected_by) {
+        m_nodes[otherWire].connected.removeAll(const_cast<class wire*>(wire));
+        if (!neighbors.contains(otherWire)) {
+            neighbors.append(otherWire);
+        }
+    }
+
+    // Every part that remains contains at least one of the neighbors. Compare them to
+    // a reference that stays in the original set and split off the smaller parts.
+    QVector<QVector<class wire*>> parts;
+    if (neighbors.isEmpty()) {
+        return parts;
+    }
+    class wire* reference = neighbors.first();
+    for (int i = 1; i < neighbors.count(); i++) {
+        auto* neighbor = neighbors.at(i);
+        if (!connected(reference, neighbor)) {
+            continue;
+        }
+        const auto part = separate(reference, neighbor);
+        if (part.isEmpty()) {
+            continue;
+        }
+        split(part);
+        parts.append(part);
+        // The reference was in the smaller part
+        if (part.first() == reference) {
+            reference = neighbor;
+        }
+    }
+
+    return parts;
+}
+
+void connectivity::clear()
+{
+    m_nodes.clear();
+    m_sets.clear();
+    m_free_sets.clear();
+}
+
+bool connectivity::contains(const wire* wire) const
+{
+    return m_nodes.contains(wire);
+}
+
+/**
+ * Adds a connection from a wire to another one. This mirrors wire::connect_wire().
+ * \return Whether the connection is new
+ */
+bool connectivity::connect(wire* wire, wire_system::wire* otherWire)
+{
+    auto it = m_nodes.find(wire);
+    auto otherIt = m_nodes.find(otherWire);
+    if (it == m_nodes.end() || otherIt == m_nodes.end() || wire == otherWire) {
+        return false;
+    }
+    if (it.value().connected.contains(otherWire)) {
+        return false;
+    }
+
+    it.value().connected.append(otherWire);
+    otherIt.value().connected_by.append(wire);
+    unite(wire, otherWire);
+
+    return true;
+}
+
+/**
+ * Removes the connection from a wire to another one. This mirrors wire::disconnectWire().
+ * \return The wires that were split off because they are no longer connected
+ */
+QVector<wire*> connectivity::disconnect(wire* wire, wire_system::wire* otherWire)
+{
+    auto it = m_nodes.find(wire);
+    auto otherIt = m_nodes.find(otherWire);
+    if (it == m_nodes.end() || otherIt == m_nodes.end()) {
+        return {};
+    }
+    if (it.value().connected.removeAll(otherWire) == 0) {
+        return {};
+    }
+    otherIt.value().connected_by.removeAll(wire);
+
+    // They are still connected the other way around
+    if (otherIt.value().connected.contains(wire)) {
+        return {};
+    }
+
+    const auto part = separate(wire, otherWire);
+    if (!part.isEmpty()) {
+        split(part);
+    }
+
+    return part;
+}
+
+/**
+ * Returns whether the two wires are in the same set
+ */
+bool connectivity::connected(const wire* a, const wire* b) const
+{
+    auto itA = m_nodes.constFind(a);
+    auto itB = m_nodes.constFind(b);
+    if (itA == m_nodes.constEnd() || itB == m_nodes.constEnd()) {
+        return false;
+    }
+
+    return itA.value().set == itB.value().set;
+}
+
+/**
+ * Returns the wires that are in the same set as the wire, including the wire itself.
+ */
+const QVector<wire*>& connectivity::component(const wire* wire) const
+{
+    static const QVector<class wire*> empty;
+
+    auto it = m_nodes.constFind(wire);
+    if (it == m_nodes.constEnd()) {
+        return empty;
+    }
+
+    return m_sets[it.value().set];
+}
+
+/**
+ * Returns the wires that have the wire in their list of connected wires
+ */
+const QVector<wire*>& connectivity::connected_by(const wire* wire) const
+{
+    static const QVector<class wire*> empty;
+
+    auto it = m_nodes.constFind(wire);
+    if (it == m_nodes.constEnd()) {
+        return empty;
+    }
+
+    return it.value().connected_by;
+}
+
+int connectivity::components_count() const
+{
+    return m_sets.count() - m_free_sets.count();
+}
+
+/**
+ * Searches the wires reachable from a and b in lockstep.
+ * \return The wires reachable from the side that was exhausted first or an empty list
+ *         if both sides are connected
+ */
+QVector<wire*> connectivity::separate(wire* a, wire* b) const
+{
+    if (a == b) {
+        return {};
+    }
+
+    QHash<const wire*, int> visitedBy;
+    QVector<wire*> queues[2] = { { a }, { b } };
+    int heads[2] = { 0, 0 };
+    visitedBy.insert(a, 0);
+    visitedBy.insert(b, 1);
+
+    while (true) {
+        for (int side = 0; side < 2; side++) {
+            auto& queue = queues[side];
+
+            // This side has been searched completely
+            if (heads[side] >= queue.count()) {
+                return queue;
+            }
+
+            const node& current = m_nodes.constFind(queue.at(heads[side]++)).value();
+            for (const auto* neighbors : { &current.connected, &current.connected_by }) {
+                for (auto* neighbor : *neighbors) {
+                    auto it = visitedBy.find(neighbor);
+                    if (it == visitedBy.end()) {
+                        visitedBy.insert(neighbor, side);
+                        queue.append(neighbor);
+                    } else if (it.value() != side) {
+                        return {};
+                    }
+                }
+            }
+        }
+    }
+}
+
+/**
+ * Unites the sets of the two wires
+ */
+void connectivity::unite(const wire* a, const wire* b)
+{
+    int setA = m_nodes[a].set;
+    int setB = m_nodes[b].set;
+    if (setA == setB) {
+        return;
+    }
+
+    // Move the smaller set
+    if (m_sets[setA].count() < m_sets[setB].count()) {
+        std::swap(setA, setB);
+    }
+    const QVector<wire*> members = std::move(m_sets[setB]);
+    m_sets[setB].clear();
+    for (wire* wire : members) {
+        move_to_set(wire, setA);
+    }
+    release_set(setB);
+}
+
+/**
+ * Moves the wires into a new set of their own
+ */
+void connectivity::split(const QVector<wire*>& wires)
+{
+    const int set = create_set();
+    for (wire* wire : wires) {
+        auto it = m_nodes.find(wire);
+        if (it == m_nodes.end()) {
+            continue;
+        }
+        take_out(it.value());
+        move_to_set(wire, set);
+    }
+
+    if (m_sets[set].isEmpty()) {
+        release_set(set);
+    }
+}
+
+int connectivity::create_set()
+{
+    if (!m_free_sets.isEmpty()) {
+        return m_free_sets.takeLast();
+    }
+
+    m_sets.append(QVector<wire*>());
+    return m_sets.count() - 1;
+}
+
+void connectivity::release_set(int set)
+{
+    m_free_sets.append(set);
+}
+
+void connectivity::move_to_set(wire* wire, int set)
+{
+    node& node = m_nodes[wire];
+    node.set = set;
+    node.position = m_sets[set].count();
+    m_sets[set].append(wire);
+}
+
+/**
+ * Removes the wire from the list of members of its set
+ */
+void connectivity::take_out(const node& node)
+{
+    auto& members = m_sets[node.set];
+
+    // Move the last member into the freed position
+    wire* last = members.last();
+    members[node.position] = last;
+    members.removeLast();
+    if (m_nodes.contains(last) && m_nodes[last].set == node.set) {
+        m_nodes[last].position = node.position;
+    }
+
+    if (members.isEmpty()) {
+        release_set(node.set);
+    }
+}
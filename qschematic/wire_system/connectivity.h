@@ -0,0 +1,63 @@
+#pragma once
+
+#include <QHash>
+#include <QVector>
+
+namespace wire_system
+{
+    class wire;
+
+    /**
+     * Keeps track of which wires are connected to each other. The wires are kept in
+     * disjoint sets: every wire points directly to the set it belongs to so finding the
+     * set of a wire takes constant time. When two sets are united the smaller one is
+     * moved into the larger one.
+     * When a connection is removed, the two sides are searched simultaneously and the
+     * search stops as soon as they meet or one of them is exhausted. This way splitting
+     * a set only costs as much as the smaller part.
+     */
+    class connectivity
+    {
+    public:
+        connectivity() = default;
+        connectivity(const connectivity& other) = delete;
+        connectivity(connectivity&& other) = delete;
+        ~connectivity() = default;
+
+        connectivity& operator=(const connectivity& rhs) = delete;
+        connectivity& operator=(connectivity&& rhs) = delete;
+
+        void insert(wire* wire);
+        QVector<QVector<wire*>> remove(const wire* wire);
+        void clear();
+        [[nodiscard]] bool contains(const wire* wire) const;
+        bool connect(wire* wire, wire_system::wire* otherWire);
+        QVector<wire*> disconnect(wire* wire, wire_system::wire* otherWire);
+        [[nodiscard]] bool connected(const wire* a, const wire* b) const;
+        [[nodiscard]] const QVector<wire*>& component(const wire* wire) const;
+        [[nodiscard]] const QVector<wire*>& connected_by(const wire* wire) const;
+        [[nodiscard]] int components_count() const;
+
+    private:
+        struct node
+        {
+            int set;
+            int position;
+            QVector<wire*> connected;       // The wires that are connected to this one
+            QVector<wire*> connected_by;    // The wires this one is connected to
+        };
+
+        [[nodiscard]] QVector<wire*> separate(wire* a, wire* b) const;
+        void unite(const wire* a, const wire* b);
+        void split(const QVector<wire*>& wires);
+        [[nodiscard]] int create_set();
+        void release_set(int set);
+        void move_to_set(wire* wire, int set);
+        void take_out(const node& node);
+
+        QHash<const wire*, node> m_nodes;
+        QVector<QVector<wire*>> m_sets;
+        QVector<int> m_free_sets;
+    };
+
+}
@@ -0,0 +1,99 @@
+#include "connector_index.h"
+#include "connectable.h"
+
+using namespace wire_system;
+
+/**
+ * Adds a connector at its current position. Nothing happens if it is already indexed.
+ */
+void connector_index::insert(const connectable* connector)
+{
+    if (!connector || contains(connector)) {
+        return;
+    }
+
+    const position_key key = key_at(connector->position());
+    m_connectors.emplace(connector, key);
+    m_positions[key].append(connector);
+}
+
+/**
+ * Moves an indexed connector to its current position
+ */
+void connector_index::moved(const connectable* connector)
+{
+    auto it = m_connectors.find(connector);
+    if (it == m_connectors.end()) {
+        return;
+    }
+
+    const position_key key = key_at(connector->position());
+    if (key == it->second) {
+        return;
+    }
+
+    unindex(connector, it->second);
+    it->second = key;
+    m_positions[key].append(connector);
+}
+
+void connector_index::remove(const connectable* connector)
+{
+    auto it = m_connectors.find(connector);
+    if (it == m_connectors.end()) {
+        return;
+    }
+
+    unindex(connector, it->second);
+    m_connectors.erase(it);
+}
+
+void connector_index::clear()
+{
+    m_positions.clear();
+    m_connectors.clear();
+}
+
+bool connector_index::contains(const connectable* connector) const
+{
+    return m_connectors.find(connector) != m_connectors.end();
+}
+
+int connector_index::connectors_count() const
+{
+    return static_cast<int>(m_connectors.size());
+}
+
+/**
+ * Returns the connectors whose position rounds to the same integer coordinates as the point
+ */
+const QVector<const connectable*>& connector_index::connectors_at(const QPointF& point) const
+{
+    static const QVector<const connectable*> none;
+
+    const auto it = m_positions.find(key_at(point));
+    if (it == m_positions.end()) {
+        return none;
+    }
+
+    return it->second;
+}
+
+connector_index::position_key connector_index::key_at(const QPointF& point)
+{
+    const QPoint rounded = point.toPoint();
+    return (static_cast<position_key>(static_cast<quint32>(rounded.x())) << 32) | static_cast<quint32>(rounded.y());
+}
+
+void connector_index::unindex(const connectable* connector, position_key key)
+{
+    auto it = m_positions.find(key);
+    if (it == m_positions.end()) {
+        return;
+    }
+
+    it->second.removeOne(connector);
+    if (it->second.isEmpty()) {
+        m_positions.erase(it);
+    }
+}
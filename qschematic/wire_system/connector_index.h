@@ -0,0 +1,48 @@
+#pragma once
+
+#include <QtGlobal>
+#include <QPointF>
+#include <QVector>
+
+#include <unordered_map>
+
+namespace wire_system
+{
+    class connectable;
+
+    /**
+     * Hashes the connectors by their position rounded to integer coordinates, the same
+     * way their positions are compared to the points of the wires. Finding the
+     * connectors at a point takes a single lookup.
+     * \remark Connectors need to be removed from the index before they get destroyed.
+     */
+    class connector_index
+    {
+    public:
+        connector_index() = default;
+        connector_index(const connector_index& other) = delete;
+        connector_index(connector_index&& other) = delete;
+        ~connector_index() = default;
+
+        connector_index& operator=(const connector_index& rhs) = delete;
+        connector_index& operator=(connector_index&& rhs) = delete;
+
+        void insert(const connectable* connector);
+        void moved(const connectable* connector);
+        void remove(const connectable* connector);
+        void clear();
+        [[nodiscard]] bool contains(const connectable* connector) const;
+        [[nodiscard]] int connectors_count() const;
+        [[nodiscard]] const QVector<const connectable*>& connectors_at(const QPointF& point) const;
+
+    private:
+        using position_key = quint64;
+
+        [[nodiscard]] static position_key key_at(const QPointF& point);
+        void unindex(const connectable* connector, position_key key);
+
+        std::unordered_map<position_key, QVector<const connectable*>> m_positions;
+        std::unordered_map<const connectable*, position_key> m_connectors;     // The key each connector is indexed under
+    };
+
+}
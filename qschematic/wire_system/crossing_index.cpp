@@ -0,0 +1,397 @@
+#include "crossing_index.h"
+#include "wire.h"
+
+#include <algorithm>
+
+using namespace wire_system;
+
+// Everything is swept again when more than half of the wires changed
+const std::size_t REBUILD_RATIO = 2;
+
+// The order of the events of the sweep that happen at the same x coordinate. Horizontal
+// segments that end or start there don't cross the vertical segments there.
+const int EVENT_REMOVE = 0;
+const int EVENT_QUERY = 1;
+const int EVENT_INSERT = 2;
+
+namespace
+{
+    bool is_horizontal(const QPointF& p1, const QPointF& p2)
+    {
+        return p1.y() == p2.y() && p1.x() != p2.x();
+    }
+
+    bool is_vertical(const QPointF& p1, const QPointF& p2)
+    {
+        return p1.x() == p2.x() && p1.y() != p2.y();
+    }
+}
+
+/**
+ * Adds a wire to the index. Nothing happens if the wire is already indexed.
+ */
+void crossing_index::insert(const std::shared_ptr<wire>& wire)
+{
+    if (!wire || m_wires.find(wire.get()) != m_wires.end()) {
+        return;
+    }
+
+    entry& entry = m_wires[wire.get()];
+    entry.ref = wire;
+    entry.dirty = true;
+    m_dirty.push_back(wire.get());
+}
+
+/**
+ * Marks the wire's crossings as outdated. They will be searched again before the next query.
+ * \return Whether the crossings of the wire were up to date
+ */
+bool crossing_index::invalidate(const wire* wire)
+{
+    auto it = m_wires.find(wire);
+    if (it == m_wires.end() || it->second.dirty) {
+        return false;
+    }
+
+    it->second.dirty = true;
+    m_dirty.push_back(wire);
+    return true;
+}
+
+void crossing_index::remove(const wire* wire)
+{
+    auto it = m_wires.find(wire);
+    if (it == m_wires.end()) {
+        return;
+    }
+
+    // Dirty entries are skipped once they are no longer in the map
+    unindex_wire(wire, it->second);
+    m_wires.erase(it);
+}
+
+void crossing_index::clear()
+{
+    m_horizontal.clear();
+    m_vertical.clear();
+    m_wires.clear();
+    m_dirty.clear();
+    m_changed.clear();
+}
+
+/**
+ * Searches the crossings of the wires that changed since the last query
+ */
+void crossing_index::update()
+{
+    if (m_dirty.empty()) {
+        return;
+    }
+
+    if (m_dirty.size() * REBUILD_RATIO > m_wires.size()) {
+        rebuild();
+        return;
+    }
+
+    // Wires that were removed and inserted again are listed twice
+    std::sort(m_dirty.begin(), m_dirty.end());
+    m_dirty.erase(std::unique(m_dirty.begin(), m_dirty.end()), m_dirty.end());
+
+    // Remove all the outdated segments first so that they aren't found as crossings
+    std::vector<std::pair<wire*, entry*>> outdated;
+    for (const wire* wire : m_dirty) {
+        auto it = m_wires.find(wire);
+        // Skip wires that have been removed in the meantime
+        if (it == m_wires.end() || !it->second.dirty) {
+            continue;
+        }
+
+        unindex_wire(wire, it->second);
+
+        // Forget about wires that no longer exist
+        auto shared = it->second.ref.lock();
+        if (!shared) {
+            m_wires.erase(it);
+            continue;
+        }
+        outdated.emplace_back(shared.get(), &it->second);
+    }
+    m_dirty.clear();
+
+    for (const auto& [wire, entry] : outdated) {
+        index_wire(wire, *entry);
+    }
+    for (const auto& [wire, entry] : outdated) {
+        entry->dirty = false;
+    }
+}
+
+/**
+ * Returns the crossings of the wire with the other wires and with itself
+ */
+const std::vector<crossing>& crossing_index::crossings(const wire* wire)
+{
+    static const std::vector<crossing> none;
+
+    update();
+    auto it = m_wires.find(wire);
+    if (it == m_wires.end()) {
+        return none;
+    }
+
+    return it->second.crossings;
+}
+
+/**
+ * Returns the crossings of the wire as they were found by the last update, without
+ * searching the outdated ones again
+ */
+const std::vector<crossing>& crossing_index::cached_crossings(const wire* wire) const
+{
+    static const std::vector<crossing> none;
+
+    auto it = m_wires.find(wire);
+    if (it == m_wires.end()) {
+        return none;
+    }
+
+    return it->second.crossings;
+}
+
+/**
+ * Returns the number of places where wires cross
+ */
+int crossing_index::crossings_count()
+{
+    update();
+
+    return cached_crossings_count();
+}
+
+/**
+ * Returns the number of places where wires cross as it was after the last update
+ */
+int crossing_index::cached_crossings_count() const
+{
+    // Each crossing is listed twice, once for each segment
+    std::size_t count = 0;
+    for (const auto& [wire, entry] : m_wires) {
+        count += entry.crossings.size();
+    }
+
+    return static_cast<int>(count / 2);
+}
+
+/**
+ * Returns the wires that didn't change but whose crossings changed because of the
+ * wires that did since the last call
+ */
+std::vector<wire*> crossing_index::take_changed()
+{
+    std::vector<wire*> changed = std::move(m_changed);
+    m_changed.clear();
+
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+    changed.erase(std::remove_if(changed.begin(), changed.end(), [this](const wire* wire) {
+        return m_wires.find(wire) == m_wires.end();
+    }), changed.end());
+
+    return changed;
+}
+
+/**
+ * Finds all the crossings again in a single sweep from left to right. The horizontal
+ * segments are active while the sweep line is between their ends and each vertical
+ * segment crosses the active ones that are within its range.
+ */
+void crossing_index::rebuild()
+{
+    m_horizontal.clear();
+    m_vertical.clear();
+    m_dirty.clear();
+
+    // The wires that had crossings will have different ones
+    for (auto it = m_wires.begin(); it != m_wires.end();) {
+        entry& entry = it->second;
+        if (entry.ref.expired()) {
+            it = m_wires.erase(it);
+            continue;
+        }
+        if (!entry.dirty && !entry.crossings.empty()) {
+            m_changed.push_back(entry.ref.lock().get());
+        }
+        entry.horizontal.clear();
+        entry.vertical.clear();
+        entry.crossings.clear();
+        ++it;
+    }
+
+    struct event
+    {
+        qreal x;
+        int type;
+        span_map::iterator span;
+    };
+    std::vector<event> events;
+    for (auto& [key, entry] : m_wires) {
+        wire* owner = entry.ref.lock().get();
+        const auto& points = owner->points();
+        for (int i = 0; i < points.count() - 1; i++) {
+            const QPointF p1 = points.at(i).toPointF();
+            const QPointF p2 = points.at(i + 1).toPointF();
+            if (is_horizontal(p1, p2)) {
+                const auto it = m_horizontal.emplace(p1.y(), span{ owner, i, qMin(p1.x(), p2.x()), qMax(p1.x(), p2.x()) });
+                entry.horizontal.push_back(it);
+                events.push_back({ it->second.from, EVENT_INSERT, it });
+                events.push_back({ it->second.to, EVENT_REMOVE, it });
+            } else if (is_vertical(p1, p2)) {
+                const auto it = m_vertical.emplace(p1.x(), span{ owner, i, qMin(p1.y(), p2.y()), qMax(p1.y(), p2.y()) });
+                entry.vertical.push_back(it);
+                events.push_back({ p1.x(), EVENT_QUERY, it });
+            }
+        }
+    }
+    std::sort(events.begin(), events.end(), [](const event& a, const event& b) {
+        return a.x < b.x || (a.x == b.x && a.type < b.type);
+    });
+
+    // The horizontal segments crossed by the sweep line by their y coordinate
+    std::multimap<qreal, span_map::iterator> active;
+    for (const event& event : events) {
+        const span& span = event.span->second;
+        if (event.type == EVENT_INSERT) {
+            active.emplace(event.span->first, event.span);
+        } else if (event.type == EVENT_REMOVE) {
+            auto [first, last] = active.equal_range(event.span->first);
+            for (auto it = first; it != last; ++it) {
+                if (it->second == event.span) {
+                    active.erase(it);
+                    break;
+                }
+            }
+        } else {
+            for (auto it = active.upper_bound(span.from); it != active.end() && it->first < span.to; ++it) {
+                const auto& horizontal = it->second->second;
+                add_crossing(horizontal.owner, horizontal.index, span.owner, span.index, QPointF(event.x, it->first));
+            }
+        }
+    }
+
+    for (auto& [key, entry] : m_wires) {
+        entry.dirty = false;
+    }
+}
+
+/**
+ * Adds the segments of the wire to the maps and finds their crossings with the segments
+ * that are already in there
+ */
+void crossing_index::index_wire(wire* wire, entry& entry)
+{
+    const auto& points = wire->points();
+
+    // The vertical segments are added before the horizontal ones are looked up and the
+    // horizontal ones after the vertical ones are, this way the crossings of the wire
+    // with itself are found once
+    for (int i = 0; i < points.count() - 1; i++) {
+        const QPointF p1 = points.at(i).toPointF();
+        const QPointF p2 = points.at(i + 1).toPointF();
+        if (is_vertical(p1, p2)) {
+            entry.vertical.push_back(m_vertical.emplace(p1.x(), span{ wire, i, qMin(p1.y(), p2.y()), qMax(p1.y(), p2.y()) }));
+        }
+    }
+
+    for (int i = 0; i < points.count() - 1; i++) {
+        const QPointF p1 = points.at(i).toPointF();
+        const QPointF p2 = points.at(i + 1).toPointF();
+        if (is_horizontal(p1, p2)) {
+            const qreal y = p1.y();
+            const qreal to = qMax(p1.x(), p2.x());
+            for (auto it = m_vertical.upper_bound(qMin(p1.x(), p2.x())); it != m_vertical.end() && it->first < to; ++it) {
+                if (it->second.from < y && y < it->second.to) {
+                    add_crossing(wire, i, it->second.owner, it->second.index, QPointF(it->first, y));
+                }
+            }
+        } else if (is_vertical(p1, p2)) {
+            const qreal x = p1.x();
+            const qreal to = qMax(p1.y(), p2.y());
+            for (auto it = m_horizontal.upper_bound(qMin(p1.y(), p2.y())); it != m_horizontal.end() && it->first < to; ++it) {
+                if (it->second.from < x && x < it->second.to) {
+                    add_crossing(it->second.owner, it->second.index, wire, i, QPointF(x, it->first));
+                }
+            }
+        }
+    }
+
+    for (int i = 0; i < points.count() - 1; i++) {
+        const QPointF p1 = points.at(i).toPointF();
+        const QPointF p2 = points.at(i + 1).toPointF();
+        if (is_horizontal(p1, p2)) {
+            entry.horizontal.push_back(m_horizontal.emplace(p1.y(), span{ wire, i, qMin(p1.x(), p2.x()), qMax(p1.x(), p2.x()) }));
+        }
+    }
+}
+
+/**
+ * Removes the segments of the wire from the maps and its crossings from the wires it crosses
+ */
+void crossing_index::unindex_wire(const wire* wire, entry& entry)
+{
+    for (const auto& it : entry.horizontal) {
+        m_horizontal.erase(it);
+    }
+    for (const auto& it : entry.vertical) {
+        m_vertical.erase(it);
+    }
+    entry.horizontal.clear();
+    entry.vertical.clear();
+
+    std::vector<wire_system::wire*> crossed;
+    for (const crossing& crossing : entry.crossings) {
+        if (crossing.other != wire) {
+            crossed.push_back(crossing.other);
+        }
+    }
+    entry.crossings.clear();
+
+    std::sort(crossed.begin(), crossed.end());
+    crossed.erase(std::unique(crossed.begin(), crossed.end()), crossed.end());
+    for (auto* other : crossed) {
+        auto it = m_wires.find(other);
+        if (it == m_wires.end()) {
+            continue;
+        }
+        auto& crossings = it->second.crossings;
+        crossings.erase(std::remove_if(crossings.begin(), crossings.end(), [wire](const crossing& crossing) {
+            return crossing.other == wire;
+        }), crossings.end());
+        changed(other);
+    }
+}
+
+void crossing_index::add_crossing(wire* horizontal, int horizontalIndex, wire* vertical, int verticalIndex, const QPointF& point)
+{
+    auto horizontalIt = m_wires.find(horizontal);
+    auto verticalIt = m_wires.find(vertical);
+    if (horizontalIt == m_wires.end() || verticalIt == m_wires.end()) {
+        return;
+    }
+
+    horizontalIt->second.crossings.push_back({ point, vertical, horizontalIndex, true });
+    verticalIt->second.crossings.push_back({ point, horizontal, verticalIndex, false });
+    changed(horizontal);
+    changed(vertical);
+}
+
+/**
+ * Remembers that the crossings of the wire changed. The wires that are being updated
+ * don't need to be told.
+ */
+void crossing_index::changed(wire* wire)
+{
+    auto it = m_wires.find(wire);
+    if (it != m_wires.end() && !it->second.dirty) {
+        m_changed.push_back(wire);
+    }
+}
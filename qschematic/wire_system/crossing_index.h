@@ -0,0 +1,94 @@
+#pragma once
+
+#include <QtGlobal>
+#include <QPointF>
+
+#include <map>
+#include <memory>
+#include <unordered_map>
+#include <vector>
+
+namespace wire_system
+{
+    class wire;
+
+    /**
+     * A place where two wires cross without being connected
+     */
+    struct crossing
+    {
+        QPointF point;
+        wire* other;            // The crossed wire, this can be the wire itself
+        int segment;            // The index of the wire's segment that crosses the other wire
+        bool horizontal;        // Whether that segment is horizontal
+    };
+
+    /**
+     * Lists the places where the horizontal and vertical segments of the wires cross.
+     * Segments only cross if the point is strictly inside of both of them: segments that
+     * touch at an end (corners, T junctions) don't cross. Segments that are neither
+     * horizontal nor vertical are ignored.
+     * The horizontal segments are kept in an ordered map by their y coordinate and the
+     * vertical ones by their x coordinate so that the segments that cross a segment are
+     * found with a range query. Like in the spatial index the wires are updated lazily,
+     * and only the crossings of the wires that changed are searched again. When most of
+     * the wires changed, e.g. after loading a file, all the crossings are found in a
+     * single sweep over the segments instead.
+     * \remark Wires need to be removed from the index before they get destroyed.
+     */
+    class crossing_index
+    {
+    public:
+        crossing_index() = default;
+        crossing_index(const crossing_index& other) = delete;
+        crossing_index(crossing_index&& other) = delete;
+        ~crossing_index() = default;
+
+        crossing_index& operator=(const crossing_index& rhs) = delete;
+        crossing_index& operator=(crossing_index&& rhs) = delete;
+
+        void insert(const std::shared_ptr<wire>& wire);
+        bool invalidate(const wire* wire);
+        void remove(const wire* wire);
+        void clear();
+        void update();
+        [[nodiscard]] const std::vector<crossing>& crossings(const wire* wire);
+        [[nodiscard]] const std::vector<crossing>& cached_crossings(const wire* wire) const;
+        [[nodiscard]] int crossings_count();
+        [[nodiscard]] int cached_crossings_count() const;
+        [[nodiscard]] std::vector<wire*> take_changed();
+
+    private:
+        // A segment by the range it covers along the coordinate it is stored under
+        struct span
+        {
+            wire* owner;
+            int index;
+            qreal from;
+            qreal to;
+        };
+        using span_map = std::multimap<qreal, span>;
+
+        struct entry
+        {
+            std::weak_ptr<wire> ref;
+            std::vector<span_map::iterator> horizontal;
+            std::vector<span_map::iterator> vertical;
+            std::vector<crossing> crossings;
+            bool dirty = true;
+        };
+
+        void rebuild();
+        void index_wire(wire* wire, entry& entry);
+        void unindex_wire(const wire* wire, entry& entry);
+        void add_crossing(wire* horizontal, int horizontalIndex, wire* vertical, int verticalIndex, const QPointF& point);
+        void changed(wire* wire);
+
+        span_map m_horizontal;                  // The horizontal segments by their y coordinate
+        span_map m_vertical;                    // The vertical segments by their x coordinate
+        std::unordered_map<const wire*, entry> m_wires;
+        std::vector<const wire*> m_dirty;
+        std::vector<wire*> m_changed;           // The up to date wires whose crossings changed
+    };
+
+}
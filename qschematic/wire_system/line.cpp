@@ -5,8 +5,19 @@
 #include <QLineF>
 #include <QVector2D>
 
+#include <cmath>
+
 using namespace wire_system;
 
+/**
+ * Returns whether both coordinates are whole numbers. This is the case for points that
+ * have been snapped to the grid.
+ */
+static bool is_integral(const QPointF& point)
+{
+    return std::trunc(point.x()) == point.x() && std::trunc(point.y()) == point.y();
+}
+
 line::line(int x1, int y1, int x2, int y2) :
     m_p1(QPointF(x1, y1)),
     m_p2(QPointF(x2, y2))
@@ -86,6 +97,18 @@ bool line::contains_point(const QLineF& line, const QPointF& point, qreal tolera
     const qreal MIN_LENGTH = 0.01;
     tolerance = qMax(tolerance, MIN_LENGTH);
 
+    // Points on the grid are checked exactly against horizontal and vertical lines. Any
+    // other point on the grid is at least one unit away, also past the ends which are
+    // extended by twice the tolerance below, so the tolerance doesn't matter.
+    if (2 * tolerance < 1 && is_integral(point) && is_integral(line.p1()) && is_integral(line.p2())) {
+        if (line.x1() == line.x2()) {
+            return point.x() == line.x1() && point.y() >= qMin(line.y1(), line.y2()) && point.y() <= qMax(line.y1(), line.y2());
+        }
+        if (line.y1() == line.y2()) {
+            return point.y() == line.y1() && point.x() >= qMin(line.x1(), line.x2()) && point.x() <= qMax(line.x1(), line.x2());
+        }
+    }
+
     if (line.isNull()) {
         QPointF linePoint = line.p1();
         if (QVector2D(linePoint).distanceToPoint(QVector2D(point)) <= tolerance) {
@@ -103,9 +126,9 @@ bool line::contains_point(const QLineF& line, const QPointF& point, qreal tolera
         QVector2D unit(normal.unitVector().dx(), normal.unitVector().dy());
         offset = (unit * -tolerance).toPointF();
         normal.translate(offset);
-        // Make the line longer by 2 * tolerance
-        QLineF lineAdjusted = line;
-        lineAdjusted.setLength(line.length() + 2 * tolerance);
+        // Make the line longer by 2 * tolerance at both ends
+        const QPointF extension = (QVector2D(line.unitVector().dx(), line.unitVector().dy()) * 2 * tolerance).toPointF();
+        const QLineF lineAdjusted(line.p1() - extension, line.p2() + extension);
 
         // Check if the lines are intersecting
 #       if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
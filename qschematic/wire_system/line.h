@@ -2,10 +2,15 @@
 
 #include <QPointF>
 
+#include <type_traits>
+
 class QLineF;
 
 namespace wire_system {
 
+    /**
+     * A line segment. Like the points, this is trivially copyable.
+     */
     class line
     {
     public:
@@ -16,8 +21,9 @@ namespace wire_system {
         line(const QPointF& p1, const QPointF& p2);
         line(const line&) = default;
         line(line&&) = default;
-        virtual ~line() = default;
+        ~line() = default;
         line& operator=(const line&) = default;
+        line& operator=(line&&) = default;
 
         [[nodiscard]] QPointF p1() const;
         [[nodiscard]] QPointF p2() const;
@@ -37,4 +43,8 @@ namespace wire_system {
         QPointF m_p2;
     };
 
+    static_assert(std::is_trivially_copyable_v<line>);
+
 }
+
+Q_DECLARE_TYPEINFO(wire_system::line, Q_PRIMITIVE_TYPE);
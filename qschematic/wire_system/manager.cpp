@@ -3,14 +3,30 @@
 #include "point.h"
 #include "wire.h"
 #include "connectable.h"
+#include "parallel.h"
 
 #include <QVector>
+#include <QHash>
 #include <QVector2D>
 
+#include <algorithm>
+
 using namespace wire_system;
 
-manager::manager()
+// The size of the spatial index cells in multiples of the grid size
+const int INDEX_CELL_SIZE = 4;
+
+// The minimum number of wires or points that are worth searching on another thread. A
+// lookup takes about 0.3 us, so a chunk takes well over ten times as long as handing it to
+// a thread of the pool.
+const int PARALLEL_CHUNK_SIZE = 512;
+
+manager::manager() :
+    m_pool(std::make_shared<wire_pool>()),
+    m_batch_depth(0),
+    m_committing(false)
 {
+    m_index.set_cell_size(m_settings.gridSize * INDEX_CELL_SIZE);
 }
 
 void manager::add_net(const std::shared_ptr<net> wireNet)
@@ -22,8 +38,17 @@ void manager::add_net(const std::shared_ptr<net> wireNet)
 
     wireNet->set_manager(this);
 
+    // The net might already contain wires
+    for (const auto& wire : wireNet->wires()) {
+        wire_added(wire);
+    }
+
     // Keep track of stuff
     m_nets.append(wireNet);
+    if (!m_net_names.contains(wireNet.get())) {
+        m_net_names.insert(wireNet.get(), wireNet->name());
+        index_net_name(wireNet, wireNet->name());
+    }
 }
 
 /**
@@ -50,21 +75,181 @@ QList<std::shared_ptr<wire>> manager::wires() const
     return list;
 }
 
+/**
+ * Returns the nets that have a certain name. These make up a global net.
+ * \remark Nets without a name are never returned.
+ */
+const QVector<std::shared_ptr<net>>& manager::nets_named(const QString& name) const
+{
+    static const QVector<std::shared_ptr<net>> empty;
+
+    auto it = m_named_nets.constFind(name);
+    if (it == m_named_nets.constEnd()) {
+        return empty;
+    }
+
+    return it.value();
+}
+
+/**
+ * Has to be called when the name of a net changed so that it can be found by its
+ * new name. Nets that don't belong to the manager are ignored.
+ */
+void manager::net_renamed(net& net)
+{
+    auto it = m_net_names.find(&net);
+    if (it == m_net_names.end()) {
+        return;
+    }
+
+    unindex_net_name(&net, it.value());
+    it.value() = net.name();
+    index_net_name(net.shared_from_this(), net.name());
+}
+
+void manager::index_net_name(const std::shared_ptr<net>& net, const QString& name)
+{
+    if (!name.isEmpty()) {
+        m_named_nets[name].append(net);
+    }
+}
+
+void manager::unindex_net_name(const net* net, const QString& name)
+{
+    if (name.isEmpty()) {
+        return;
+    }
+
+    auto it = m_named_nets.find(name);
+    if (it == m_named_nets.end()) {
+        return;
+    }
+
+    auto& nets = it.value();
+    for (int i = 0; i < nets.count(); i++) {
+        if (nets.at(i).get() == net) {
+            nets.remove(i);
+            break;
+        }
+    }
+    if (nets.isEmpty()) {
+        m_named_nets.erase(it);
+    }
+}
+
+/**
+ * Connects every wire whose first or last point lies on another wire. The ends
+ * are only tested against the segments in the same cell of the spatial index.
+ */
 void manager::generate_junctions()
 {
-    for (const auto& wire: wires()) {
-        for (auto& otherWire: wires()) {
-            if (wire == otherWire) {
+    // The nets that are merged are removed all at once when the batch is committed
+    begin_batch();
+    connect_ends(wires(), nullptr);
+    commit();
+}
+
+/**
+ * Connects the wires whose first or last point lies on another wire.
+ * \param filter If set, only connections that involve one of these wires are made
+ */
+void manager::connect_ends(const QList<std::shared_ptr<wire>>& wires, const QSet<const wire*>* filter)
+{
+    struct end_on_wire
+    {
+        const wire* owner;      // The wire the end lies on
+        wire* otherWire;
+        int index;
+    };
+
+    // Find the wires on which the ends lie. This doesn't modify the geometry so it can be done
+    // beforehand, and the wires are searched in chunks on several threads.
+    m_index.update();
+    const auto found = map_chunks<QVector<end_on_wire>>(wires.count(), PARALLEL_CHUNK_SIZE, [&](int begin, int end) {
+        QVector<end_on_wire> ends;
+        for (int i = begin; i < end; i++) {
+            const auto& otherWire = wires.at(i);
+            if (otherWire->points_count() < 1) {
                 continue;
             }
-            if (wire->point_is_on_wire(otherWire->points().first().toPointF())) {
-                connect_wire(wire.get(), otherWire.get(), 0);
+            const bool otherIsFiltered = filter && filter->contains(otherWire.get());
+            const int lastIndex = otherWire->points_count() - 1;
+            for (const int index : { 0, lastIndex }) {
+                const QPointF point = otherWire->points().at(index).toPointF();
+                m_index.for_each_indexed_segment_near(point, [&](const spatial_index::segment& segment) {
+                    if (segment.owner == otherWire.get() || segment.index < 0) {
+                        return true;
+                    }
+                    if (filter && !otherIsFiltered && !filter->contains(segment.owner)) {
+                        return true;
+                    }
+                    if (segment.geometry.contains_point(point, 0)) {
+                        ends.append({ segment.owner, otherWire.get(), index });
+                    }
+                    return true;
+                });
+                // Single point wires
+                if (lastIndex == 0) {
+                    break;
+                }
             }
-            if (wire->point_is_on_wire(otherWire->points().last().toPointF())) {
-                connect_wire(wire.get(), otherWire.get(), otherWire->points().count() - 1);
+        }
+        return ends;
+    });
+
+    // Merge the chunks in order so that the result doesn't depend on the number of threads
+    QHash<const wire*, QVector<QPair<wire*, int>>> endsOnWire;
+    for (const auto& ends : found) {
+        for (const auto& end : ends) {
+            // A point on a corner lies on two segments of the same wire
+            auto& list = endsOnWire[end.owner];
+            if (!list.contains({ end.otherWire, end.index })) {
+                list.append({ end.otherWire, end.index });
             }
         }
     }
+
+    // Connect them in the same order as the wires are listed
+    for (const auto& wire : wires) {
+        for (const auto& [otherWire, index] : endsOnWire.value(wire.get())) {
+            connect_wire(wire.get(), otherWire, index);
+        }
+    }
+}
+
+/**
+ * Connects the ends of the wires that were added during a batch and the ends of the other
+ * wires that lie on them. Only the wires that share a cell of the spatial index with one
+ * of the added wires are considered.
+ */
+void manager::connect_added_wires(const QVector<const wire*>& addedWires)
+{
+    const QSet<const wire*> filter(addedWires.cbegin(), addedWires.cend());
+
+    // The added wires come first, in the order in which they were added
+    QList<std::shared_ptr<wire>> candidates;
+    QSet<const wire*> listed;
+    for (const auto* addedWire : addedWires) {
+        if (auto shared = m_index.shared_wire(addedWire)) {
+            candidates.append(shared);
+            listed.insert(addedWire);
+        }
+    }
+
+    // Followed by the wires close to them
+    for (const auto* addedWire : addedWires) {
+        m_index.for_each_segment_near_wire(addedWire, [&](const spatial_index::segment& segment) {
+            if (!listed.contains(segment.owner)) {
+                listed.insert(segment.owner);
+                if (auto shared = m_index.shared_wire(segment.owner)) {
+                    candidates.append(shared);
+                }
+            }
+            return true;
+        });
+    }
+
+    connect_ends(candidates, &filter);
 }
 
 /**
@@ -75,12 +260,19 @@ void manager::generate_junctions()
 void manager::connect_wire(wire* wire, wire_system::wire* rawWire, std::size_t point)
 {
     if (!wire->connect_wire(rawWire)) {
+        // Already connected through another junction
+        rawWire->set_point_is_junction(point, true);
         return;
     }
-    std::shared_ptr<wire_system::net> net = wire->net();
-    std::shared_ptr<wire_system::net> otherNet = rawWire->net();
-    if (merge_nets(net, otherNet)) {
-        remove_net(otherNet);
+    m_connectivity.connect(wire, rawWire);
+
+    if (auto mergedNet = merge_nets(wire->net(), rawWire->net())) {
+        // Removing a net is linear so do it only once for all the merges of a batch
+        if (m_batch_depth > 0 || m_committing) {
+            m_batch_merged_nets.insert(mergedNet.get());
+        } else {
+            remove_net(mergedNet);
+        }
     }
 
     // Set the wire point to be a junction
@@ -88,77 +280,154 @@ void manager::connect_wire(wire* wire, wire_system::wire* rawWire, std::size_t p
 }
 
 /**
- * Merges two wirenets into one
- * \param net The net into which the other one will be merged
- * \param otherNet The net to merge into the other one
- * \return Whether the two nets where merged successfully or not
+ * Merges two wirenets into one. The smaller net is merged into the larger one.
+ * \return The net that is now empty or nullptr if the nets were not merged
  */
-bool manager::merge_nets(std::shared_ptr<net>& net, std::shared_ptr<wire_system::net>& otherNet)
+std::shared_ptr<net> manager::merge_nets(const std::shared_ptr<net>& net, const std::shared_ptr<wire_system::net>& otherNet)
 {
     // Ignore if it's the same net
-    if (net == otherNet) {
-        return false;
+    if (!net || !otherNet || net == otherNet) {
+        return nullptr;
     }
-    for (auto& wire: otherNet->wires()) {
-        net->addWire(wire);
-        otherNet->removeWire(wire);
+
+    auto target = net;
+    auto source = otherNet;
+    if (target->wires_count() < source->wires_count()) {
+        std::swap(target, source);
     }
-    return true;
+
+    // Don't lose the name of the net
+    if (target->name().isEmpty() && !source->name().isEmpty()) {
+        target->set_name(source->name());
+    }
+
+    target->merge(source);
+
+    return source;
 }
 
 void manager::remove_net(std::shared_ptr<net> net)
 {
+    // Forget about the wires that are still part of the net
+    if (net) {
+        for (const auto& wire : net->wires()) {
+            if (wire && wire->net() == net) {
+                forget_pending_changes(wire.get());
+                detach_wire_from_all(wire.get());
+                m_index.remove(wire.get());
+                m_router.remove(wire.get());
+                m_crossings.remove(wire.get());
+                m_reroutes.remove(wire.get());
+                m_connectivity.remove(wire.get());
+            }
+        }
+    }
+
     m_nets.removeAll(net);
+    if (net) {
+        m_batch_merged_nets.remove(net.get());
+        unindex_net_name(net.get(), m_net_names.take(net.get()));
+    }
 }
 
 void manager::clear()
 {
     m_nets.clear();
+    m_net_names.clear();
+    m_named_nets.clear();
+    m_index.clear();
+    m_router.clear();
+    m_crossings.clear();
+    m_outdated_crossings.clear();
+    m_reroutes.clear();
+    m_connectivity.clear();
+    m_connector_positions.clear();
+    m_connections.clear();
+    m_attachments.clear();
+    m_batch_wires.clear();
+    m_batch_moved_wires.clear();
+    m_batch_moved_points.clear();
+    m_batch_connectors.clear();
+    m_batch_merged_nets.clear();
+    m_changed_wires.clear();
+}
+
+/**
+ * Forgets about the changes of a wire that are waiting for the batch to be committed or
+ * for the wire to be simplified
+ */
+void manager::forget_pending_changes(wire* wire)
+{
+    if (m_batch_moved_points.remove(wire) > 0) {
+        m_batch_moved_wires.removeOne(wire);
+    }
+    m_batch_wires.removeOne(wire);
+    m_changed_wires.remove(wire);
+    m_outdated_crossings.removeOne(wire);
 }
 
 bool manager::remove_wire(const std::shared_ptr<wire> wire)
 {
+    forget_pending_changes(wire.get());
+
     // Detach from all connectors
     detach_wire_from_all(wire.get());
 
-    // Disconnect from connected wires
-    for (const auto& otherWire: wires_connected_to(wire)) {
-        if (otherWire != wire) {
-            disconnect_wire(otherWire, wire.get());
-            // Update the junction on the other wire
-            for (int index = 0; index < otherWire->points_count(); index++) {
-                const auto point = otherWire->points().at(index);
-                if (!point.is_junction()) {
-                    continue;
-                }
-                if (wire->point_is_on_wire(point.toPointF())) {
-                    otherWire->set_point_is_junction(index, false);
+    // Disconnect from the wires it ends on
+    for (auto* otherWire : m_connectivity.connected_by(wire.get())) {
+        otherWire->disconnectWire(wire.get());
+    }
+    const QList<wire_system::wire*> endingOnWire = wire->connected_wires();
+
+    // The wires that end on this one only keep the junctions that are on another wire they are connected to
+    for (auto* otherWire : wire->connected_wires()) {
+        const auto& targets = m_connectivity.connected_by(otherWire);
+        const bool hasOtherTargets = std::any_of(targets.cbegin(), targets.cend(), [&wire](const auto* target) {
+            return target != wire.get();
+        });
+        for (int index : otherWire->junctions()) {
+            const QPointF point = otherWire->points().at(index).toPointF();
+            bool keep = false;
+            if (hasOtherTargets) {
+                keep = !wire->point_is_on_wire(point);
+                for (const auto* target : targets) {
+                    if (target != wire.get() && target->point_is_on_wire(point)) {
+                        keep = true;
+                        break;
+                    }
                 }
             }
+            if (!keep) {
+                otherWire->set_point_is_junction(index, false);
+            }
         }
     }
 
-    // Remove the wire from the list
-    QList<std::shared_ptr<net>> netsToDelete;
-    for (auto& net : m_nets) {
-        if (net->contains(wire)) {
-            net->removeWire(wire);
-        }
+    // The remaining wires might not be connected anymore
+    for (const auto& part : m_connectivity.remove(wire.get())) {
+        move_to_new_net(part);
+    }
 
-        if (net->wires().count() < 1) {
-            netsToDelete.append(net);
+    // Remove the wire from the net and delete the net if this was its last wire
+    if (auto net = wire->net()) {
+        net->removeWire(wire);
+        if (net->wires_count() < 1) {
+            remove_net(net);
         }
     }
 
-    // Delete the net if this was the nets last wire
-    for (auto& net : netsToDelete) {
-        remove_net(net);
+    m_index.remove(wire.get());
+    m_router.remove(wire.get());
+    m_crossings.remove(wire.get());
+    m_reroutes.remove(wire.get());
+
+    for (auto* otherWire : endingOnWire) {
+        update_junctions(*otherWire);
     }
 
     return true;
 }
 
-
 /**
  * Generates a list of all the wires connected to a certain wire including the
  * wire itself.
@@ -170,35 +439,26 @@ QVector<std::shared_ptr<wire>> manager::wires_connected_to(const std::shared_ptr
     // Add the wire itself to the list
     connectedWires.push_back(wire);
 
-    QVector<std::shared_ptr<wire_system::wire>> newList;
-    do {
-        newList.clear();
-        // Go through all the wires in the net
-        for (const auto& otherWire: wire->net()->wires()) {
-            // Ignore if the wire is already in the list
-            if (connectedWires.contains(otherWire)) {
-                continue;
-            }
-
-            // If they are connected to one of the wire in the list add them to the new list
-            for (const auto& wire2 : connectedWires) {
-                if (wire2->connected_wires().contains(otherWire.get())) {
-                    newList << otherWire;
-                    break;
-                }
-                if (otherWire->connected_wires().contains(wire2.get())) {
-                    newList << otherWire;
-                    break;
-                }
-            }
+    for (auto* otherWire : m_connectivity.component(wire.get())) {
+        if (otherWire == wire.get()) {
+            continue;
         }
-
-        connectedWires << newList;
-    } while (!newList.isEmpty());
+        if (auto sharedWire = m_index.shared_wire(otherWire)) {
+            connectedWires.push_back(sharedWire);
+        }
+    }
 
     return connectedWires;
 }
 
+/**
+ * Returns whether the two wires are connected, directly or through other wires
+ */
+bool manager::are_connected(const wire* wire, const wire_system::wire* otherWire) const
+{
+    return m_connectivity.connected(wire, otherWire);
+}
+
 /**
  * Disconnects the a wire from another and takes care of updating the wirenets.
  * \param wire The wire that the other is attached to
@@ -207,22 +467,46 @@ QVector<std::shared_ptr<wire>> manager::wires_connected_to(const std::shared_ptr
 void manager::disconnect_wire(const std::shared_ptr<wire_system::wire>& wire, wire_system::wire* otherWire)
 {
     wire->disconnectWire(otherWire);
-    auto net = otherWire->net();
-    // Create a list of wires that will stay in the old net
-    QVector<std::shared_ptr<wire_system::wire>> oldWires = wires_connected_to(wire);
-    // If there are wires that are not in the list create a new net
-    if (net->wires().count() != oldWires.count()) {
-        // Create new net and add the wire
-        auto newNet = create_net();
-        add_net(std::static_pointer_cast<wire_system::net>(newNet));
-        for (auto wireToMove: net->wires()) {
-            if (oldWires.contains(wireToMove)) {
-                continue;
+
+    // Move the wires that are no longer connected to a new net
+    const auto part = m_connectivity.disconnect(wire.get(), otherWire);
+    if (!part.isEmpty()) {
+        move_to_new_net(part);
+    }
+}
+
+/**
+ * Moves wires that are no longer connected to the rest of their net to a new net
+ */
+void manager::move_to_new_net(const QVector<wire*>& wires)
+{
+    auto newNet = create_net();
+    add_net(std::static_pointer_cast<wire_system::net>(newNet));
+
+    QList<std::shared_ptr<wire_system::wire>> wiresToMove;
+    std::shared_ptr<net> oldNet;
+    for (auto* wireToMove : wires) {
+        auto sharedWire = m_index.shared_wire(wireToMove);
+        if (!sharedWire) {
+            continue;
+        }
+        if (!oldNet) {
+            oldNet = sharedWire->net();
+        }
+
+        // The wires are normally all in the same net
+        if (sharedWire->net() == oldNet) {
+            wiresToMove.append(sharedWire);
+        } else {
+            if (auto net = sharedWire->net()) {
+                net->removeWire(sharedWire);
             }
-            newNet->addWire(wireToMove);
-            net->removeWire(wireToMove);
+            newNet->addWire(sharedWire);
         }
     }
+    if (oldNet) {
+        newNet->take_wires(oldNet, wiresToMove);
+    }
 }
 
 bool manager::add_wire(const std::shared_ptr<wire>& wire)
@@ -239,10 +523,63 @@ bool manager::add_wire(const std::shared_ptr<wire>& wire)
     newNet->addWire(wire);
     add_net(std::static_pointer_cast<wire_system::net>(newNet));
 
+    // Its junctions are generated when the batch is committed
+    if (m_batch_depth > 0) {
+        m_batch_wires.append(wire.get());
+    }
+
     return true;
 }
 
+/**
+ * Has to be called when the user moved a point of a wire. This connects or disconnects
+ * the ends of the wire and emits wire_point_moved(). During a batch this is deferred
+ * until the batch is committed.
+ */
 void manager::point_moved_by_user(wire& rawWire, int index)
+{
+    if (m_batch_depth > 0) {
+        auto& indices = m_batch_moved_points[&rawWire];
+        if (indices.isEmpty()) {
+            m_batch_moved_wires.append(&rawWire);
+        }
+        if (!indices.contains(index)) {
+            indices.append(index);
+        }
+        return;
+    }
+
+    process_point_moved(rawWire, index);
+}
+
+/**
+ * Makes sure that a wire has junctions if and only if it is connected to the
+ * wires it ends on
+ */
+void manager::update_junctions(wire& rawWire)
+{
+    const auto& targets = m_connectivity.connected_by(&rawWire);
+
+    // Nothing to be a junction on
+    if (targets.isEmpty()) {
+        for (int index : rawWire.junctions()) {
+            rawWire.set_point_is_junction(index, false);
+        }
+        return;
+    }
+
+    // Nothing that keeps it connected
+    if (rawWire.junctions().isEmpty()) {
+        const QVector<wire*> oldTargets = targets;
+        for (auto* target : oldTargets) {
+            if (const auto sharedTarget = m_index.shared_wire(target)) {
+                disconnect_wire(sharedTarget, &rawWire);
+            }
+        }
+    }
+}
+
+void manager::process_point_moved(wire& rawWire, int index)
 {
     point point = rawWire.points().at(index);
 
@@ -251,13 +588,16 @@ void manager::point_moved_by_user(wire& rawWire, int index)
     // Detach wires
     if (index == 0 || index == rawWire.points_count() - 1){
         if (point.is_junction()) {
-            for (const auto& wire: wires()) {
+            // The wires that the wire is connected to
+            const QVector<wire_system::wire*> candidates = m_connectivity.connected_by(&rawWire);
+            for (auto* candidate : candidates) {
                 // Skip current wire
-                if (wire.get() == &rawWire) {
+                if (candidate == &rawWire) {
                     continue;
                 }
                 // If is connected
-                if (wire->connected_wires().contains(&rawWire)) {
+                const auto wire = m_index.shared_wire(candidate);
+                if (wire) {
                     bool shouldDisconnect = true;
                     // Keep the wires connected if there is another junction
                     for (const auto& jIndex : rawWire.junctions()) {
@@ -283,18 +623,29 @@ void manager::point_moved_by_user(wire& rawWire, int index)
 
     // Attach point to wire if needed
     if (index == 0 || index == rawWire.points().count() - 1) {
-        for (const auto& wire: wires()) {
-            // Skip current wire
-            if (wire.get() == &rawWire) {
-                continue;
+        const QPointF position = rawWire.points().at(index).toPointF();
+
+        // Connecting modifies the wires so the candidates have to be collected first
+        QVector<wire*> candidates;
+        m_index.for_each_segment_near(position, [&](const spatial_index::segment& segment) {
+            // Skip current wire and single points
+            if (segment.owner == &rawWire || segment.index < 0) {
+                return true;
             }
-            if (wire->point_is_on_wire(rawWire.points().at(index).toPointF())) {
-                if (!rawWire.connected_wires().contains(wire.get())) {
-                    connect_wire(wire.get(), &rawWire, index);
-                }
+            if (!candidates.contains(segment.owner) && segment.geometry.contains_point(position, 0)) {
+                candidates.append(segment.owner);
+            }
+            return true;
+        });
+
+        for (const auto& wire : candidates) {
+            if (!rawWire.connected_wires().contains(wire)) {
+                connect_wire(wire, &rawWire, index);
             }
         }
     }
+
+    update_junctions(rawWire);
 }
 
 void manager::attach_wire_to_connector(wire* wire, int index, const connectable* connector)
@@ -314,6 +665,7 @@ void manager::attach_wire_to_connector(wire* wire, int index, const connectable*
     }
 
     m_connections.insert(connector, {wire, index });
+    m_attachments[wire].append(connector);
 }
 
 /**
@@ -335,12 +687,9 @@ void manager::attach_wire_to_connector(wire* wire, const connectable* connector)
 
 void manager::point_inserted(const wire* wire, int index)
 {
-    for (const auto& connector : m_connections.keys()) {
-        // Skip if it's not the connected to the wire
-        auto wirePoint = m_connections.value(connector);
-        if (m_connections.value(connector).first != wire) {
-            continue;
-        }
+    // Only the connectors attached to this wire are affected
+    for (const auto& connector : attached_connectors(wire)) {
+        auto& wirePoint = m_connections[connector];
         // Do nothing if the connected point is the first
         if (wirePoint.second == 0) {
             continue;
@@ -349,80 +698,201 @@ void manager::point_inserted(const wire* wire, int index)
         else if (wirePoint.second >= index || wirePoint.second == wire->points_count() - 2) {
             wirePoint.second++;
         }
-        // Update the connection
-        m_connections.insert(connector, wirePoint);
     }
 }
 
 void manager::point_removed(const wire* wire, int index)
 {
-    for (const auto& connector : m_connections.keys()) {
-        // Skip if it's not the connected to the wire
-        auto wirePoint = m_connections.value(connector);
-        if (m_connections.value(connector).first != wire) {
-            continue;
-        }
+    // Only the connectors attached to this wire are affected
+    for (const auto& connector : attached_connectors(wire)) {
+        auto& wirePoint = m_connections[connector];
         if (wirePoint.second >= index) {
             wirePoint.second--;
         }
-        // Update the connection
-        m_connections.insert(connector, wirePoint);
     }
 }
 
 void manager::detach_wire(const connectable* connector)
 {
-    // ToDo: This doesn't seem robust at all
-    const auto& wire = m_connections.value(connector).first;
-    m_connections.remove(connector);
+    m_batch_connectors.removeOne(connector);
+
+    auto it = m_connections.find(connector);
+    if (it == m_connections.end()) {
+        return;
+    }
+
+    // Remove the connector from the wire's attachments
+    auto attachments = m_attachments.find(it.value().first);
+    if (attachments != m_attachments.end()) {
+        attachments.value().removeOne(connector);
+        if (attachments.value().isEmpty()) {
+            m_attachments.erase(attachments);
+        }
+    }
+
+    m_connections.erase(it);
 }
 
 std::shared_ptr<wire> manager::wire_with_extremity_at(const QPointF& point)
 {
-    for (const auto& wire : wires()) {
-        for (const auto& p : wire->points()) {
-            if (p.toPoint() == point.toPoint()) {
-                return wire;
-            }
-        }
+    m_index.update();
+    if (auto* wire = wire_ending_at(point)) {
+        return m_index.shared_wire(wire);
     }
     return nullptr;
 }
 
-void manager::detach_wire_from_all(const wire* wire)
+/**
+ * Returns the wire that has its first or last point at each of the points, or nullptr
+ * if there is none. The points are searched in chunks on several threads.
+ */
+QVector<wire*> manager::wires_with_extremity_at(const QVector<QPointF>& points)
 {
-    for (const auto& connector : m_connections.keys()) {
-        // Skip if it's not the connected to the wire
-        if (m_connections.value(connector).first != wire) {
-            continue;
+    m_index.update();
+    const auto found = map_chunks<QVector<wire*>>(points.count(), PARALLEL_CHUNK_SIZE, [&](int begin, int end) {
+        QVector<wire*> wires;
+        wires.reserve(end - begin);
+        for (int i = begin; i < end; i++) {
+            wires.append(wire_ending_at(points.at(i)));
+        }
+        return wires;
+    });
+
+    QVector<wire*> wires;
+    wires.reserve(points.count());
+    for (const auto& chunk : found) {
+        wires += chunk;
+    }
+    return wires;
+}
+
+/**
+ * Returns the wire that has its first or last point at the point or nullptr if there is
+ * none. This doesn't re-index the wires so it can be called from several threads.
+ */
+wire* manager::wire_ending_at(const QPointF& point) const
+{
+    wire* result = nullptr;
+    m_index.for_each_indexed_segment_near(point, [&](const spatial_index::segment& segment) {
+        // Only the first point of the first segment has to be checked as the others start where the previous one ends
+        if ((segment.index == 0 && segment.geometry.p1().toPoint() == point.toPoint()) ||
+            segment.geometry.p2().toPoint() == point.toPoint()) {
+            result = segment.owner;
         }
+        return !result;
+    });
+    return result;
+}
 
+void manager::detach_wire_from_all(const wire* wire)
+{
+    const auto connectors = m_attachments.take(wire);
+    for (const auto& connector : connectors) {
         m_connections.remove(connector);
     }
 }
 
-wire* manager::attached_wire(const connectable* connector)
+wire* manager::attached_wire(const connectable* connector) const
 {
-    if (!m_connections.contains(connector)) {
+    auto it = m_connections.constFind(connector);
+    if (it == m_connections.constEnd()) {
         return nullptr;
     }
-    return m_connections.value(connector).first;
+    return it.value().first;
 }
 
-int manager::attached_point(const connectable* connector)
+int manager::attached_point(const connectable* connector) const
 {
-    if (!m_connections.contains(connector)) {
+    auto it = m_connections.constFind(connector);
+    if (it == m_connections.constEnd()) {
         return -1;
     }
-    return m_connections.value(connector).second;
+    return it.value().second;
+}
+
+/**
+ * Returns the connectors that are attached to the wire
+ */
+const QVector<const connectable*>& manager::attached_connectors(const wire* wire) const
+{
+    static const QVector<const connectable*> empty;
+
+    auto it = m_attachments.constFind(wire);
+    if (it == m_attachments.constEnd()) {
+        return empty;
+    }
+
+    return it.value();
+}
+
+/**
+ * Lets the manager know about a connector so that it can be found by its position
+ */
+void manager::add_connector(const connectable* connector)
+{
+    m_connector_positions.insert(connector);
+}
+
+void manager::remove_connector(const connectable* connector)
+{
+    m_connector_positions.remove(connector);
+}
+
+/**
+ * Returns the connectors known to the manager whose position rounds to the same integer
+ * coordinates as the point
+ */
+const QVector<const connectable*>& manager::connectors_at(const QPointF& point) const
+{
+    return m_connector_positions.connectors_at(point);
 }
 
 void manager::connector_moved(const connectable* connector)
 {
-    if (!m_connections.contains(connector)) {
+    m_connector_positions.moved(connector);
+
+    auto it = m_connections.constFind(connector);
+    if (it == m_connections.constEnd()) {
         return;
     }
-    const auto wirePoint = m_connections.value(connector);
+
+    // The wire follows the connector once the batch is committed
+    if (m_batch_depth > 0) {
+        if (!m_batch_connectors.contains(connector)) {
+            m_batch_connectors.append(connector);
+        }
+        return;
+    }
+
+    if (m_settings.rerouteAttachedWires) {
+        // Outside of a batch the wire isn't moved again so there's nothing to keep
+        const wire* wire = it.value().first;
+        reroute_wires({ connector });
+        m_reroutes.remove(wire);
+    } else {
+        follow_connector(connector);
+    }
+}
+
+/**
+ * Forgets about the parts of the wires that were kept while re-routing them. This needs
+ * to be called once the connectors stop moving, e.g. when the user releases the nodes.
+ */
+void manager::clear_reroute_cache()
+{
+    m_reroutes.clear();
+}
+
+/**
+ * Moves the point of the wire that is attached to the connector
+ */
+void manager::follow_connector(const connectable* connector)
+{
+    auto it = m_connections.constFind(connector);
+    if (it == m_connections.constEnd()) {
+        return;
+    }
+    const auto wirePoint = it.value();
 
     if (wirePoint.second < -1 || wirePoint.first->points_count() <= wirePoint.second) {
         return;
@@ -435,25 +905,506 @@ void manager::connector_moved(const connectable* connector)
     }
 }
 
+/**
+ * Re-routes the segments next to the ends of the wires that are attached to the moved
+ * connectors. Each wire is processed once, no matter how many of its connectors moved.
+ * The moving ends are removed from all the wires before any of them is routed so that
+ * the paths don't have to avoid where the other wires were in the previous frame, then
+ * the paths are routed all at once.
+ */
+void manager::reroute_wires(const QVector<const connectable*>& connectors)
+{
+    const QSet<const connectable*> moved(connectors.cbegin(), connectors.cend());
+
+    QVector<wire*> wires;
+    QSet<const wire*> seen;
+    for (const auto* connector : connectors) {
+        auto it = m_connections.constFind(connector);
+        if (it != m_connections.constEnd() && !seen.contains(it.value().first)) {
+            seen.insert(it.value().first);
+            wires.append(it.value().first);
+        }
+    }
+
+    struct pending
+    {
+        wire* target;
+        std::optional<QPointF> start;
+        std::optional<QPointF> end;
+        int oldLast;
+        int firstConnection;                                // The index of its first path in the connections
+    };
+    QVector<pending> rerouted;
+    QVector<QPair<QPointF, QPointF>> connections;
+    QVector<const connectable*> followers;
+
+    for (auto* wire : wires) {
+        const int last = wire->points_count() - 1;
+        pending entry { wire, { }, { }, last, static_cast<int>(connections.count()) };
+        QVector<const connectable*> others;
+        for (const auto* connector : attached_connectors(wire)) {
+            if (!moved.contains(connector)) {
+                continue;
+            }
+            const int index = m_connections.value(connector).second;
+            if (index == 0) {
+                entry.start = connector->position();
+            } else if (index == last) {
+                entry.end = connector->position();
+            } else {
+                others.append(connector);
+            }
+        }
+
+        // The connectors that aren't attached to an end of the wire move its point
+        if (entry.start || entry.end) {
+            // Copied because the cache can change while the wire is modified
+            const reroute_entry kept = reroute_entry_of(*wire, entry.start.has_value(), entry.end.has_value());
+            if (kept.fixed) {
+                others = attached_connectors(wire);
+            } else {
+                if (kept.kept.isEmpty()) {
+                    wire->set_points({ point(*entry.start) });
+                    connections.append({ *entry.start, *entry.end });
+                } else {
+                    wire->set_points(kept.kept);
+                    if (entry.start) {
+                        connections.append({ *entry.start, kept.kept.first().toPointF() });
+                    }
+                    if (entry.end) {
+                        connections.append({ kept.kept.last().toPointF(), *entry.end });
+                    }
+                }
+                rerouted.append(entry);
+            }
+        }
+        for (const auto* connector : others) {
+            if (moved.contains(connector)) {
+                followers.append(connector);
+            }
+        }
+    }
+
+    const auto paths = m_router.route_all(connections);
+
+    // Falls back to a single straight angle if there's no path
+    auto append_path = [&](QVector<point>& points, int connection) {
+        const auto& [from, to] = connections.at(connection);
+        auto path = paths.at(connection);
+        if (path.isEmpty()) {
+            path = { QPointF(to.x(), from.y()), to };
+        }
+        for (const QPointF& pathPoint : path) {
+            points.append(point(pathPoint));
+        }
+    };
+
+    for (const auto& entry : rerouted) {
+        const auto& kept = m_reroutes.value(entry.target).kept;
+        int connection = entry.firstConnection;
+        QVector<point> points;
+        if (kept.isEmpty()) {
+            points.append(point(*entry.start));
+            append_path(points, connection);
+        } else {
+            if (entry.start) {
+                points.append(point(*entry.start));
+                append_path(points, connection++);
+                points.removeLast();
+            }
+            points.append(kept);
+            if (entry.end) {
+                append_path(points, connection);
+            }
+        }
+        entry.target->set_points(points);
+
+        // The connectors attached to the last point stay attached to it
+        for (const auto* connector : attached_connectors(entry.target)) {
+            auto& wirePoint = m_connections[connector];
+            if (wirePoint.second == entry.oldLast || wirePoint.second >= points.count()) {
+                wirePoint.second = points.count() - 1;
+            }
+        }
+    }
+
+    for (const auto* connector : followers) {
+        follow_connector(connector);
+    }
+}
+
+/**
+ * Returns the part of the wire that is kept while its ends are re-routed. It is the part
+ * that didn't move when the ends started moving so that the paths don't depend on the
+ * previous moves.
+ */
+const manager::reroute_entry& manager::reroute_entry_of(wire& wire, bool start, bool end)
+{
+    auto it = m_reroutes.find(&wire);
+    if (it != m_reroutes.end() && it->start == start && it->end == end) {
+        return it.value();
+    }
+
+    const auto& points = wire.points();
+    const int first = start ? qMin(2, points.count() - 1) : 0;
+    const int last = end ? qMax(points.count() - 3, 0) : points.count() - 1;
+
+    reroute_entry entry;
+    entry.start = start;
+    entry.end = end;
+    entry.kept = first <= last ? points.mid(first, last - first + 1) : QVector<point>();
+
+    // The junctions of the other wires would be left behind
+    auto is_rerouted = [&](const QPointF& position) {
+        for (int i = 0; i < points.count() - 1; i++) {
+            if ((i < first || i >= last) && wire.segment(i).contains_point(position)) {
+                return true;
+            }
+        }
+        return false;
+    };
+    entry.fixed = false;
+    for (const auto* otherWire : wire.connected_wires()) {
+        for (int index : otherWire->junctions()) {
+            if (is_rerouted(otherWire->points().at(index).toPointF())) {
+                entry.fixed = true;
+            }
+        }
+    }
+
+    return m_reroutes.insert(&wire, entry).value();
+}
+
 /**
  * Returns whether the wire's point is attached to a connector
  */
 bool manager::point_is_attached(wire_system::wire* wire, int index) const
 {
-    for (const auto& wire_point : m_connections.values()) {
-        if (wire_point.first != wire) {
-            continue;
-        }
-        if (wire_point.second == index) {
+    for (const auto& connector : attached_connectors(wire)) {
+        if (m_connections.value(connector).second == index) {
             return true;
         }
     }
     return false;
 }
 
+/**
+ * Starts a batch of edits. Until the batch is committed, the wires that follow moved
+ * connectors, the junctions of added wires and the processing of the points moved by
+ * the user are deferred. Batches can be nested, only the outermost commit() resolves
+ * the changes.
+ */
+void manager::begin_batch()
+{
+    m_batch_depth++;
+}
+
+/**
+ * Ends a batch of edits and resolves the deferred changes in one pass
+ */
+void manager::commit()
+{
+    // Sanity check
+    if (m_batch_depth < 1) {
+        return;
+    }
+
+    m_batch_depth--;
+    if (m_batch_depth > 0) {
+        return;
+    }
+    m_committing = true;
+
+    // Move the wires attached to the connectors
+    const auto connectors = std::move(m_batch_connectors);
+    m_batch_connectors.clear();
+    if (m_settings.rerouteAttachedWires) {
+        reroute_wires(connectors);
+    } else {
+        for (const auto* connector : connectors) {
+            follow_connector(connector);
+        }
+    }
+
+    // Connect the wires that were added
+    const auto addedWires = std::move(m_batch_wires);
+    m_batch_wires.clear();
+    if (!addedWires.isEmpty()) {
+        connect_added_wires(addedWires);
+    }
+
+    // Process the points that were moved
+    const auto movedWires = std::move(m_batch_moved_wires);
+    const auto movedPoints = std::move(m_batch_moved_points);
+    m_batch_moved_wires.clear();
+    m_batch_moved_points.clear();
+    for (auto* wire : movedWires) {
+        for (int index : movedPoints.value(wire)) {
+            // The point might have been removed in the meantime
+            if (index < wire->points_count()) {
+                process_point_moved(*wire, index);
+            }
+        }
+    }
+
+    // Remove the nets that are empty after merging. The wires might have been moved
+    // to other nets afterwards so check that they're still empty.
+    if (!m_batch_merged_nets.isEmpty()) {
+        QList<std::shared_ptr<net>> nets;
+        nets.reserve(m_nets.count());
+        for (const auto& net : m_nets) {
+            if (!m_batch_merged_nets.contains(net.get()) || net->wires_count() > 0) {
+                nets.append(net);
+            } else {
+                unindex_net_name(net.get(), m_net_names.take(net.get()));
+            }
+        }
+        m_nets = nets;
+        m_batch_merged_nets.clear();
+    }
+
+    m_committing = false;
+}
+
+/**
+ * Returns whether a batch of edits is in progress
+ */
+bool manager::in_batch() const
+{
+    return m_batch_depth > 0;
+}
+
+/**
+ * Adds or moves an obstacle that the routed wires go around
+ * \param owner Identifies the obstacle, usually the item it belongs to
+ */
+void manager::set_obstacle(const void* owner, const QRectF& rect)
+{
+    m_router.set_obstacle(owner, rect);
+}
+
+void manager::remove_obstacle(const void* owner)
+{
+    m_router.remove_obstacle(owner);
+}
+
+/**
+ * Finds an orthogonal path on the grid with as few bends as possible that goes around
+ * the obstacles and doesn't run along other wires.
+ * \param ignoredWire A wire that the path may run along, usually the one being routed
+ * \return The points after the first one up to the last one, or an empty list if no path
+ *         was found
+ */
+QVector<QPointF> manager::route(const QPointF& from, const QPointF& to, const wire* ignoredWire)
+{
+    return m_router.route(from, to, ignoredWire);
+}
+
+/**
+ * Finds the paths of several connections at once on worker threads. The paths go
+ * around the obstacles and don't run along the existing wires nor along each other.
+ * \param report Receives the statistics of the routing if not nullptr
+ * \return The points after the first one of each path, empty if none was found
+ */
+QVector<QVector<QPointF>> manager::route_all(const QVector<QPair<QPointF, QPointF>>& connections, routing_report* report)
+{
+    return m_router.route_all(connections, report);
+}
+
+/**
+ * Searches the crossings of the wires that changed and emits crossings_changed() once for
+ * each of them and for each of the other wires whose crossings changed because of them
+ */
+void manager::update_crossings()
+{
+    m_crossings.update();
+
+    // A wire that changed can also have had its crossings changed by another one. Swapping
+    // keeps the capacity of the list without letting the receivers modify it while it's
+    // iterated.
+    QVector<wire*> changed;
+    changed.swap(m_outdated_crossings);
+    for (auto* wire : m_crossings.take_changed()) {
+        changed.append(wire);
+    }
+    std::sort(changed.begin(), changed.end());
+    changed.erase(std::unique(changed.begin(), changed.end()), changed.end());
+
+    for (auto* wire : changed) {
+        emit crossings_changed(*wire);
+    }
+    changed.clear();
+    if (m_outdated_crossings.isEmpty()) {
+        m_outdated_crossings.swap(changed);
+    }
+}
+
+/**
+ * Returns the places where the wire crosses other wires, or itself, without being
+ * connected to them, as they were when update_crossings() was last called. This doesn't
+ * search them again or emit anything, so it can be used while painting.
+ */
+const std::vector<crossing>& manager::crossings(const wire* wire) const
+{
+    return m_crossings.cached_crossings(wire);
+}
+
+/**
+ * Returns the number of places where wires cross without being connected, as it was when
+ * update_crossings() was last called
+ */
+int manager::crossings_count() const
+{
+    return m_crossings.cached_crossings_count();
+}
+
+/**
+ * Returns the pool that hands out the handles of the wires of the nets of this manager
+ */
+const std::shared_ptr<wire_pool>& manager::pool() const
+{
+    return m_pool;
+}
+
 void manager::set_settings(const Settings& settings)
 {
     m_settings = settings;
+    m_index.set_cell_size(m_settings.gridSize * INDEX_CELL_SIZE);
+    m_router.set_grid_size(m_settings.gridSize);
+}
+
+/**
+ * Registers a wire in the spatial index and the connectivity. This is called by
+ * the nets when a wire is added to them.
+ */
+void manager::wire_added(const std::shared_ptr<wire>& wire)
+{
+    m_index.insert(wire);
+    m_router.insert(wire);
+    m_crossings.insert(wire);
+    outdate_crossings(wire.get());
+
+    // The wire might already be connected to other wires
+    m_connectivity.insert(wire.get());
+    for (auto* otherWire : wire->connected_wires()) {
+        m_connectivity.connect(wire.get(), otherWire);
+    }
+}
+
+/**
+ * Has to be called whenever the points of a wire have been modified so that the
+ * spatial index can be kept up to date.
+ */
+void manager::wire_points_changed(wire* wire)
+{
+    m_index.invalidate(wire);
+    m_router.invalidate(wire);
+    if (m_crossings.invalidate(wire)) {
+        outdate_crossings(wire);
+    }
+    m_changed_wires.insert(wire);
+}
+
+/**
+ * Remembers that the crossings of the wire have to be searched again. The first wire
+ * emits crossings_outdated() so that they can be updated before the next time the
+ * wires are painted.
+ */
+void manager::outdate_crossings(wire* wire)
+{
+    if (m_outdated_crossings.isEmpty()) {
+        emit crossings_outdated();
+    }
+    m_outdated_crossings.append(wire);
+}
+
+void manager::wire_simplified(wire* wire)
+{
+    m_changed_wires.remove(wire);
+}
+
+/**
+ * Returns whether one of the junctions of the wire lies on the target
+ */
+static bool has_junction_on(const wire& wire, const wire_system::wire& target)
+{
+    for (int index : wire.junctions()) {
+        if (target.point_is_on_wire(wire.points().at(index).toPointF())) {
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Has to be called once the junctions that a change of the wire pushed around have been
+ * moved. The wires that no longer have a junction on each other are disconnected and the
+ * ends that left the wires they were on are no longer junctions.
+ */
+void manager::wire_settled(wire* wire)
+{
+    const auto sharedWire = m_index.shared_wire(wire);
+    if (!sharedWire) {
+        return;
+    }
+
+    // The wires that end on this one. Disconnecting removes them from the list.
+    for (int i = wire->connected_wires().count() - 1; i >= 0; i--) {
+        auto* otherWire = wire->connected_wires().at(i);
+        if (!has_junction_on(*otherWire, *wire)) {
+            disconnect_wire(sharedWire, otherWire);
+            update_junctions(*otherWire);
+        }
+    }
+
+    // The wires that this one ends on
+    for (int i = m_connectivity.connected_by(wire).count() - 1; i >= 0; i--) {
+        auto* target = m_connectivity.connected_by(wire).at(i);
+        if (has_junction_on(*wire, *target)) {
+            continue;
+        }
+        if (const auto sharedTarget = m_index.shared_wire(target)) {
+            disconnect_wire(sharedTarget, wire);
+        }
+    }
+
+    // The ends that left the wires they were on are no longer junctions
+    update_end_junctions(*wire);
+    for (auto* otherWire : wire->connected_wires()) {
+        update_end_junctions(*otherWire);
+    }
+}
+
+/**
+ * Makes the ends of the wire junctions exactly when they lie on a wire that it is connected to
+ */
+void manager::update_end_junctions(wire& rawWire)
+{
+    const auto& targets = m_connectivity.connected_by(&rawWire);
+    for (int index : { 0, rawWire.points_count() - 1 }) {
+        if (index < 0) {
+            continue;
+        }
+        const QPointF point = rawWire.points().at(index).toPointF();
+        const bool onTarget = std::any_of(targets.cbegin(), targets.cend(), [&point](const wire* target) {
+            return target->point_is_on_wire(point);
+        });
+        if (rawWire.points().at(index).is_junction() != onTarget) {
+            rawWire.set_point_is_junction(index, onTarget);
+        }
+    }
+}
+
+/**
+ * Simplifies the wires whose points changed since they were last simplified
+ */
+void manager::simplify_changed_wires()
+{
+    // Simplifying a wire removes it from the set
+    const auto wires = m_changed_wires;
+    for (auto& wire : wires) {
+        wire->simplify();
+    }
 }
 
 Settings manager::settings() const
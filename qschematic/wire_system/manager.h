@@ -1,10 +1,18 @@
 #pragma once
 
+#include "connectivity.h"
+#include "connector_index.h"
+#include "crossing_index.h"
+#include "point.h"
+#include "router.h"
+#include "spatial_index.h"
+#include "wire_pool.h"
 #include "../settings.h"
 
 #include <QObject>
 #include <QList>
-#include <QMap>
+#include <QHash>
+#include <QSet>
 
 #include <memory>
 #include <optional>
@@ -41,6 +49,8 @@ public:
 
     void add_net(const std::shared_ptr<net> wireNet);
     [[nodiscard]] QList<std::shared_ptr<net>> nets() const;
+    [[nodiscard]] const QVector<std::shared_ptr<net>>& nets_named(const QString& name) const;
+    void net_renamed(net& net);
     [[nodiscard]] QList<std::shared_ptr<wire>> wires() const;
     void generate_junctions();
     void connect_wire(wire* wire, wire_system::wire* rawWire, std::size_t point);
@@ -48,36 +58,106 @@ public:
     void clear();
     bool remove_wire(const std::shared_ptr<wire> wire);
     [[nodiscard]] QVector<std::shared_ptr<wire>> wires_connected_to(const std::shared_ptr<wire>& wire) const;
+    [[nodiscard]] bool are_connected(const wire* wire, const wire_system::wire* otherWire) const;
     void disconnect_wire(const std::shared_ptr<wire_system::wire>& wire, wire_system::wire* otherWire);
     bool add_wire(const std::shared_ptr<wire>& wire);
     void attach_wire_to_connector(wire* wire, int index, const connectable* connector);
     void attach_wire_to_connector(wire* wire, const connectable* connector);
-    [[nodiscard]] wire* attached_wire(const connectable* connector);
-    [[nodiscard]] int attached_point(const connectable* connector);
+    [[nodiscard]] wire* attached_wire(const connectable* connector) const;
+    [[nodiscard]] int attached_point(const connectable* connector) const;
+    [[nodiscard]] const QVector<const connectable*>& attached_connectors(const wire* wire) const;
     void detach_wire(const connectable* connector);
     [[nodiscard]] std::shared_ptr<wire> wire_with_extremity_at(const QPointF& point);
+    [[nodiscard]] QVector<wire*> wires_with_extremity_at(const QVector<QPointF>& points);
     void point_inserted(const wire* wire, int index);
     [[nodiscard]] bool point_is_attached(wire_system::wire* wire, int index) const;
     void set_settings(const Settings& settings);
     [[nodiscard]] Settings settings() const;
     void point_removed(const wire* wire, int index);
+    void wire_added(const std::shared_ptr<wire>& wire);
+    void wire_points_changed(wire* wire);
+    void wire_simplified(wire* wire);
+    void wire_settled(wire* wire);
+    void simplify_changed_wires();
     void point_moved_by_user(wire& rawWire, int index);
     void set_net_factory(std::function<std::shared_ptr<net>()> func);
+    void add_connector(const connectable* connector);
+    void remove_connector(const connectable* connector);
     void connector_moved(const connectable* connector);
+    [[nodiscard]] const QVector<const connectable*>& connectors_at(const QPointF& point) const;
+    void clear_reroute_cache();
+    void begin_batch();
+    void commit();
+    [[nodiscard]] bool in_batch() const;
+    [[nodiscard]] const std::shared_ptr<wire_pool>& pool() const;
+    void set_obstacle(const void* owner, const QRectF& rect);
+    void remove_obstacle(const void* owner);
+    [[nodiscard]] QVector<QPointF> route(const QPointF& from, const QPointF& to, const wire* ignoredWire = nullptr);
+    [[nodiscard]] QVector<QVector<QPointF>> route_all(const QVector<QPair<QPointF, QPointF>>& connections, routing_report* report = nullptr);
+    void update_crossings();
+    [[nodiscard]] const std::vector<crossing>& crossings(const wire* wire) const;
+    [[nodiscard]] int crossings_count() const;
 
 signals:
     void wire_point_moved(wire& wire, int index);
+    void crossings_changed(wire& wire);
+    void crossings_outdated();
 
 private:
-    [[nodiscard]] static bool merge_nets(std::shared_ptr<wire_system::net>& net, std::shared_ptr<wire_system::net>& otherNet);
-
+    // The part of a wire that is kept while the segments next to its moving ends are re-routed
+    struct reroute_entry
+    {
+        QVector<point> kept;
+        bool start;                                         // Whether the first point is re-routed
+        bool end;
+        bool fixed;                                         // Whether the wire can't be re-routed because other wires end on the re-routed segments
+    };
+
+    [[nodiscard]] static std::shared_ptr<net> merge_nets(const std::shared_ptr<wire_system::net>& net, const std::shared_ptr<wire_system::net>& otherNet);
+
+    void move_to_new_net(const QVector<wire*>& wires);
+    void connect_ends(const QList<std::shared_ptr<wire>>& wires, const QSet<const wire*>* filter);
+    void connect_added_wires(const QVector<const wire*>& addedWires);
+    void process_point_moved(wire& rawWire, int index);
+    void update_junctions(wire& rawWire);
+    void update_end_junctions(wire& rawWire);
+    void index_net_name(const std::shared_ptr<net>& net, const QString& name);
+    void unindex_net_name(const net* net, const QString& name);
     void detach_wire_from_all(const wire* wire);
+    void forget_pending_changes(wire* wire);
+    void outdate_crossings(wire* wire);
+    void follow_connector(const connectable* connector);
+    void reroute_wires(const QVector<const connectable*>& connectors);
+    [[nodiscard]] const reroute_entry& reroute_entry_of(wire& wire, bool start, bool end);
+    [[nodiscard]] wire* wire_ending_at(const QPointF& point) const;
     [[nodiscard]] std::shared_ptr<net> create_net();
 
     QList<std::shared_ptr<net>> m_nets;
+    std::shared_ptr<wire_pool> m_pool;                      // The wires of the nets
+    QHash<const net*, QString> m_net_names;                 // The name each net of the manager is indexed under
+    QHash<QString, QVector<std::shared_ptr<net>>> m_named_nets;     // The nets that have each name, unnamed nets aren't listed
     Settings m_settings;
-    QMap<const connectable*, QPair<wire*, int>> m_connections;
+    spatial_index m_index;
+    router m_router;
+    crossing_index m_crossings;
+    QVector<wire*> m_outdated_crossings;                    // The wires whose crossings changed since they were last searched
+    connectivity m_connectivity;
+    connector_index m_connector_positions;
+    QHash<const connectable*, QPair<wire*, int>> m_connections;     // The wire and point each connector is attached to
+    QHash<const wire*, QVector<const connectable*>> m_attachments;  // The connectors attached to each wire
     std::optional<std::function<std::shared_ptr<net>()>> m_net_factory;
+    QSet<wire*> m_changed_wires;                            // The wires whose points changed since they were last simplified
+
+    QHash<const wire*, reroute_entry> m_reroutes;
+
+    // Batch editing
+    int m_batch_depth;
+    QVector<const wire*> m_batch_wires;                     // The wires added during the batch
+    QVector<wire*> m_batch_moved_wires;                     // The wires with points moved by the user during the batch
+    QHash<const wire*, QVector<int>> m_batch_moved_points;
+    QVector<const connectable*> m_batch_connectors;         // The connectors moved during the batch
+    QSet<const net*> m_batch_merged_nets;                   // The nets that are empty after merging
+    bool m_committing;
 };
 
 }
@@ -1,15 +1,27 @@
 #include "net.h"
 #include "wire.h"
+#include "manager.h"
 
 #include <QString>
 
 using namespace wire_system;
 
-net::net() : m_manager(nullptr)
+net::net() : m_removed_count(0), m_manager(nullptr)
 {
 
 }
 
+net::~net()
+{
+    if (!m_pool) {
+        return;
+    }
+
+    for (const auto& handle : m_wires) {
+        m_pool->release(handle);
+    }
+}
+
 void net::set_name(const std::string& name)
 {
     set_name(QString::fromStdString(name));
@@ -17,7 +29,16 @@ void net::set_name(const std::string& name)
 
 void net::set_name(const QString& name)
 {
+    if (name == m_name) {
+        return;
+    }
+
     m_name = name;
+
+    // Let the manager know so that the net can be found by its name
+    if (m_manager) {
+        m_manager->net_renamed(*this);
+    }
 }
 
 QString net::name() const
@@ -29,13 +50,36 @@ QList<std::shared_ptr<wire>> net::wires() const
 {
     QList<std::shared_ptr<wire>> list;
 
-    for (const auto& wire: m_wires) {
-        list.append(wire.lock());
+    if (!m_pool) {
+        return list;
+    }
+
+    for (const auto& handle : m_wires) {
+        if (auto wire = m_pool->shared(handle)) {
+            list.append(std::move(wire));
+        }
     }
 
     return list;
 }
 
+/**
+ * Returns a view of the wires that doesn't allocate. Prefer this over wires()
+ * when iterating.
+ */
+net::wire_view net::raw_wires() const
+{
+    return wire_view(m_wires, m_pool.get());
+}
+
+/**
+ * Returns the number of wires in the net
+ */
+int net::wires_count() const
+{
+    return m_wires.count() - m_removed_count;
+}
+
 bool net::addWire(const std::shared_ptr<wire>& wire)
 {
     // Sanity check
@@ -61,40 +105,173 @@ bool net::addWire(const std::shared_ptr<wire>& wire)
     wire->set_manager(manager());
 
     // Add the wire
-    m_wires.append(wire);
+    append_entry(wire);
+
+    // Let the manager know about the wire
+    if (m_manager) {
+        m_manager->wire_added(wire);
+    }
 
     return true;
 }
 
 bool net::removeWire(const std::shared_ptr<wire> wire)
 {
-    for (auto it = m_wires.begin(); it != m_wires.end(); it++) {
-        if ((*it).lock() == wire) {
-            m_wires.erase(it);
-            break;
-        }
-    }
+    remove_entry(wire.get());
 
     return true;
 }
 
-bool net::contains(const std::shared_ptr<wire>& wire) const
+/**
+ * Moves all the wires of the other net into this one. The other net is empty
+ * afterwards.
+ */
+void net::merge(const std::shared_ptr<net>& other)
 {
-    for (const auto& w : m_wires) {
-        if (w.lock() == wire) {
-            return true;
+    // Sanity check
+    if (!other || other.get() == this) {
+        return;
+    }
+
+    take_wires(other, other->wires());
+}
+
+/**
+ * Moves some of the wires of the other net into this one. Unlike addWire() and
+ * removeWire() this doesn't update the junctions as the connections of the wires
+ * don't change.
+ */
+void net::take_wires(const std::shared_ptr<net>& other, const QList<std::shared_ptr<wire>>& wires)
+{
+    // Sanity check
+    if (!other || other.get() == this) {
+        return;
+    }
+
+    for (const auto& wire : wires) {
+        if (!wire || !other->m_indices.contains(wire.get())) {
+            continue;
+        }
+
+        // Adding it first keeps its slot if both nets share the same pool
+        wire->setNet(shared_from_this());
+        wire->set_manager(manager());
+        append_entry(wire);
+        other->remove_entry(wire.get());
+
+        // Let the manager know about the wire
+        if (m_manager) {
+            m_manager->wire_added(wire);
         }
     }
+}
 
-    return false;
+bool net::contains(const std::shared_ptr<wire>& wire) const
+{
+    return m_indices.contains(wire.get());
 }
 
+/**
+ * Sets the manager of the net. The wires are moved to the pool of the manager.
+ */
 void net::set_manager(class manager* manager)
 {
     m_manager = manager;
+
+    // The wires can stay in the current pool if there's no new one
+    auto newPool = manager ? manager->pool() : nullptr;
+    if (!newPool || newPool == m_pool) {
+        return;
+    }
+    if (!m_pool) {
+        m_pool = std::move(newPool);
+        return;
+    }
+
+    // Move the wires to the pool of the manager
+    for (auto& handle : m_wires) {
+        if (handle.is_null()) {
+            continue;
+        }
+        const auto* rawWire = m_pool->address(handle);
+        const auto wire = m_pool->shared(handle);
+        m_pool->release(handle);
+        handle = newPool->acquire(wire);
+
+        // The wire doesn't exist anymore
+        if (handle.is_null()) {
+            m_indices.remove(rawWire);
+            m_removed_count++;
+        }
+    }
+    m_pool = std::move(newPool);
 }
 
 manager* net::manager() const
 {
     return m_manager;
 }
+
+/**
+ * Returns the pool the wires are stored in
+ */
+wire_pool& net::pool()
+{
+    if (!m_pool) {
+        m_pool = m_manager ? m_manager->pool() : std::make_shared<wire_pool>();
+    }
+
+    return *m_pool;
+}
+
+void net::append_entry(const std::shared_ptr<wire>& wire)
+{
+    // Don't add the same wire twice
+    auto it = m_indices.constFind(wire.get());
+    if (it != m_indices.constEnd()) {
+        // Unless the entry belongs to a destroyed wire that had the same address
+        handle& handle = m_wires[it.value()];
+        if (!pool().get(handle)) {
+            pool().release(handle);
+            handle = pool().acquire(wire);
+        }
+        return;
+    }
+
+    m_indices.insert(wire.get(), m_wires.count());
+    m_wires.append(pool().acquire(wire));
+}
+
+/**
+ * Removes the wire in constant time by leaving a hole in the list. The holes are
+ * removed once they make up half of the list.
+ */
+void net::remove_entry(const wire* wire)
+{
+    auto it = m_indices.find(wire);
+    if (it == m_indices.end()) {
+        return;
+    }
+
+    pool().release(m_wires.at(it.value()));
+    m_wires[it.value()] = { };
+    m_indices.erase(it);
+    m_removed_count++;
+
+    if (m_removed_count * 2 < m_wires.count()) {
+        return;
+    }
+
+    // Remove the holes
+    QVector<handle> handles;
+    handles.reserve(m_wires.count() - m_removed_count);
+    for (const auto& handle : m_wires) {
+        // The wires that have been destroyed in the meantime keep their entries
+        if (const auto* wire = m_pool->address(handle)) {
+            m_indices[wire] = handles.count();
+            handles.append(handle);
+        }
+    }
+    m_wires = handles;
+    m_removed_count = 0;
+}
@@ -1,6 +1,10 @@
 #pragma once
 
+#include "wire_pool.h"
+
 #include <QList>
+#include <QVector>
+#include <QHash>
 
 #include <memory>
 
@@ -18,17 +22,66 @@ namespace wire_system
         public std::enable_shared_from_this<net>
     {
     public:
+        /**
+         * A view of the wires of a net that doesn't allocate. The wires that have been
+         * destroyed in the meantime are skipped.
+         * \remark The view is invalidated when wires are added to or removed from the net.
+         */
+        class wire_view
+        {
+        public:
+            class iterator
+            {
+            public:
+                iterator(const handle* current, const handle* end, const wire_pool* pool) : m_current(current), m_end(end), m_pool(pool), m_wire(nullptr) { skip_removed(); }
+
+                [[nodiscard]] wire* operator*() const { return m_wire; }
+                iterator& operator++() { m_current++; skip_removed(); return *this; }
+                [[nodiscard]] bool operator==(const iterator& other) const { return m_current == other.m_current; }
+                [[nodiscard]] bool operator!=(const iterator& other) const { return m_current != other.m_current; }
+
+            private:
+                void skip_removed()
+                {
+                    for (; m_current != m_end; m_current++) {
+                        if ((m_wire = m_pool->get(*m_current))) {
+                            return;
+                        }
+                    }
+                    m_wire = nullptr;
+                }
+
+                const handle* m_current;
+                const handle* m_end;
+                const wire_pool* m_pool;
+                wire* m_wire;
+            };
+
+            wire_view(const QVector<handle>& handles, const wire_pool* pool) : m_handles(handles), m_pool(pool) { }
+
+            [[nodiscard]] iterator begin() const { return iterator(m_handles.constData(), m_handles.constData() + m_handles.count(), m_pool); }
+            [[nodiscard]] iterator end() const { return iterator(m_handles.constData() + m_handles.count(), m_handles.constData() + m_handles.count(), m_pool); }
+
+        private:
+            const QVector<handle>& m_handles;
+            const wire_pool* m_pool;
+        };
+
         net();
         net(const net&) = delete;
         net(net&&) = delete;
-        virtual ~net() = default;
+        virtual ~net();
 
         void set_name(const std::string& name);
         virtual void set_name(const QString& name);
         [[nodiscard]] QString name() const;
         [[nodiscard]] QList<std::shared_ptr<wire>> wires() const;
+        [[nodiscard]] wire_view raw_wires() const;
+        [[nodiscard]] int wires_count() const;
         virtual bool addWire(const std::shared_ptr<wire>& wire);
         virtual bool removeWire(const std::shared_ptr<wire> wire);
+        void merge(const std::shared_ptr<net>& other);
+        virtual void take_wires(const std::shared_ptr<net>& other, const QList<std::shared_ptr<wire>>& wires);
         [[nodiscard]] bool contains(const std::shared_ptr<wire>& wire) const;
         void set_manager(wire_system::manager* manager);
 
@@ -36,7 +89,14 @@ namespace wire_system
         class manager* manager() const;
 
     private:
-        QList<std::weak_ptr<wire>> m_wires;
+        [[nodiscard]] wire_pool& pool();
+        void append_entry(const std::shared_ptr<wire>& wire);
+        void remove_entry(const wire* wire);
+
+        std::shared_ptr<wire_pool> m_pool;      // The pool of the manager or a pool of its own if it never had one
+        QVector<handle> m_wires;                // Null handles for the wires that have been removed
+        QHash<const wire*, int> m_indices;
+        int m_removed_count;
         class manager* m_manager;
         QString m_name;
     };
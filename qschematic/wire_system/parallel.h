@@ -0,0 +1,96 @@
+#pragma once
+
+#include <QtGlobal>
+#include <QRunnable>
+#include <QSemaphore>
+#include <QThreadPool>
+
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+namespace wire_system
+{
+    namespace detail
+    {
+        /**
+         * Runs one chunk of map_chunks() on the thread pool and signals when it's done
+         */
+        template<typename Run>
+        class chunk_task :
+            public QRunnable
+        {
+        public:
+            chunk_task(const Run& run, int chunk, QSemaphore& done) :
+                m_run(run),
+                m_chunk(chunk),
+                m_done(done)
+            {
+                setAutoDelete(false);
+            }
+
+            void run() override
+            {
+                m_run(m_chunk);
+                m_done.release();
+            }
+
+        private:
+            const Run& m_run;
+            int m_chunk;
+            QSemaphore& m_done;
+        };
+    }
+
+    /**
+     * Splits the range [0, count) into contiguous chunks, one per thread of the global
+     * thread pool, and calls the function with the bounds of each chunk. The results are
+     * returned in the order of the chunks so that merging them gives the same result as a
+     * serial run.
+     * Ranges that aren't larger than the minimum chunk size are processed on the calling
+     * thread without involving the pool. The chunks that no thread of the pool has picked
+     * up by the time the calling thread is done with its own are run by the calling thread,
+     * so it's safe to call this from a thread of the pool.
+     * \remark The function must not modify anything that the other chunks read.
+     */
+    template<typename Result, typename Function>
+    std::vector<Result> map_chunks(int count, int minimumChunkSize, Function&& function)
+    {
+        QThreadPool* pool = QThreadPool::globalInstance();
+        const int threadsCount = std::max(1, pool->maxThreadCount());
+        const int chunksCount = std::clamp(count / std::max(1, minimumChunkSize), 1, threadsCount);
+
+        std::vector<Result> results(chunksCount);
+        if (chunksCount == 1) {
+            results[0] = function(0, count);
+            return results;
+        }
+
+        const auto run = [&](int chunk) {
+            const int begin = static_cast<int>(static_cast<qint64>(count) * chunk / chunksCount);
+            const int end = static_cast<int>(static_cast<qint64>(count) * (chunk + 1) / chunksCount);
+            results[chunk] = function(begin, end);
+        };
+
+        // The calling thread processes the first chunk
+        QSemaphore done;
+        std::vector<std::unique_ptr<detail::chunk_task<decltype(run)>>> tasks;
+        tasks.reserve(chunksCount - 1);
+        for (int chunk = 1; chunk < chunksCount; chunk++) {
+            tasks.push_back(std::make_unique<detail::chunk_task<decltype(run)>>(run, chunk, done));
+            pool->start(tasks.back().get());
+        }
+        run(0);
+
+        // Don't wait for the chunks that are still queued
+        for (auto& task : tasks) {
+            if (pool->tryTake(task.get())) {
+                task->run();
+            }
+        }
+        done.acquire(chunksCount - 1);
+
+        return results;
+    }
+
+}
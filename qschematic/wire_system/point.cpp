@@ -8,12 +8,6 @@ point::point() :
     m_is_junction = false;
 }
 
-point::point(const point& other) :
-    QPointF(other)
-{
-    m_is_junction = other.m_is_junction;
-}
-
 point::point(const QPoint& point) :
     QPointF(point)
 {
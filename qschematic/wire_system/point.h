@@ -2,8 +2,14 @@
 
 #include <QPointF>
 
+#include <type_traits>
+
 namespace wire_system {
 
+    /**
+     * A point of a wire. This has no virtual functions and is trivially copyable so that
+     * containers of points can be relocated with memcpy.
+     */
     class point :
         private QPointF
     {
@@ -18,14 +24,15 @@ namespace wire_system {
         using QPointF::toPoint;
 
         point();
-        point(const point& other);
+        point(const point& other) = default;
         point(point&&) = default;
         point(const QPoint& point);
         point(const QPointF& point);
         point(int x, int y);
         point(qreal x, qreal y);
-        virtual ~point() = default;
+        ~point() = default;
         point& operator=(const point&) = default;
+        point& operator=(point&&) = default;
 
         QPointF toPointF() const;
         void set_is_junction(bool isJunction);
@@ -34,8 +41,16 @@ namespace wire_system {
     private:
         bool m_is_junction;
     };
+
+    static_assert(std::is_trivially_copyable_v<point>);
 }
 
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    Q_DECLARE_TYPEINFO(wire_system::point, Q_RELOCATABLE_TYPE);
+#else
+    Q_DECLARE_TYPEINFO(wire_system::point, Q_MOVABLE_TYPE);
+#endif
+
 bool operator==(const wire_system::point& a, const wire_system::point& b);
 bool operator==(const wire_system::point& a, const QPoint& b);
 bool operator==(const wire_system::point& a, const QPointF& b);
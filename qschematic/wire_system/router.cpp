@@ -0,0 +1,734 @@
+#include "router.h"
+#include "parallel.h"
+#include "wire.h"
+
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <functional>
+#include <unordered_set>
+
+using namespace wire_system;
+
+const int DEFAULT_GRID_SIZE = 20;
+
+// The flags of the grid points of the search window
+const quint8 BLOCKED = 0x01;
+const quint8 HORIZONTAL = 0x02;
+const quint8 VERTICAL = 0x04;
+const quint8 NOT_LOADED = 0x80;
+
+// The search is limited to the bounding rectangle of the two points grown by a margin
+// of this many grid points plus half of its size
+const int WINDOW_MARGIN = 16;
+const int MAX_WINDOW_SIZE = 512;
+const int MAX_EXPANSIONS = 200000;
+
+// Routing several connections
+const int PARALLEL_ROUTING_CHUNK_SIZE = 16;
+const int MAX_ROUTING_PASSES = 8;
+const int MAX_RIP_UPS = 2;                      // The number of times each connection can make room for itself
+
+// A bend costs more than any path in the window is long so that the path with the
+// fewest bends is always preferred
+const qint64 BEND_COST = qint64(1) << 32;
+
+// Right, down, left and up
+const int DIRECTION_X[4] = { 1, 0, -1, 0 };
+const int DIRECTION_Y[4] = { 0, 1, 0, -1 };
+
+namespace
+{
+    int tile_coordinate(int value, int tileSize)
+    {
+        return value >= 0 ? value / tileSize : (value - tileSize + 1) / tileSize;
+    }
+
+    /**
+     * Returns a lower bound of the number of bends needed to reach a point that is
+     * (dx, dy) away when moving in a direction
+     */
+    int min_bends(int direction, int dx, int dy)
+    {
+        if (dx == 0 && dy == 0) {
+            return 0;
+        }
+
+        const int forward = dx * DIRECTION_X[direction] + dy * DIRECTION_Y[direction];
+        const int side = direction % 2 == 0 ? dy : dx;
+        if (side == 0) {
+            return forward > 0 ? 0 : 2;
+        }
+        return forward >= 0 ? 1 : 2;
+    }
+}
+
+double routing_report::connections_per_second() const
+{
+    return seconds > 0 ? connections / seconds : 0;
+}
+
+router::router() :
+    m_grid_size(DEFAULT_GRID_SIZE)
+{
+}
+
+/**
+ * Changes the size of the grid. This marks all the obstacles and wires again.
+ */
+void router::set_grid_size(int size)
+{
+    if (size <= 0) {
+        size = DEFAULT_GRID_SIZE;
+    }
+    if (size == m_grid_size) {
+        return;
+    }
+
+    m_grid_size = size;
+
+    // The bitmap is no longer valid
+    m_tiles.clear();
+    m_dirty_wires.clear();
+    m_dirty_obstacles.clear();
+    for (auto& [wire, entry] : m_wires) {
+        entry.marks.clear();
+        entry.dirty = true;
+        m_dirty_wires.push_back(wire);
+    }
+    for (auto& [owner, entry] : m_obstacles) {
+        entry.marked = QRect();
+        entry.dirty = true;
+        m_dirty_obstacles.push_back(owner);
+    }
+}
+
+int router::grid_size() const
+{
+    return m_grid_size;
+}
+
+/**
+ * Adds a wire that paths must not run along. Nothing happens if the wire is already known.
+ */
+void router::insert(const std::shared_ptr<wire>& wire)
+{
+    if (!wire || m_wires.find(wire.get()) != m_wires.end()) {
+        return;
+    }
+
+    wire_entry& entry = m_wires[wire.get()];
+    entry.ref = wire;
+    entry.dirty = true;
+    m_dirty_wires.push_back(wire.get());
+}
+
+/**
+ * Marks the wire as outdated. It will be marked again before the next search.
+ */
+void router::invalidate(const wire* wire)
+{
+    auto it = m_wires.find(wire);
+    if (it == m_wires.end() || it->second.dirty) {
+        return;
+    }
+
+    it->second.dirty = true;
+    m_dirty_wires.push_back(wire);
+}
+
+void router::remove(const wire* wire)
+{
+    auto it = m_wires.find(wire);
+    if (it == m_wires.end()) {
+        return;
+    }
+
+    // Dirty entries are skipped once they are no longer in the map
+    unmark(it->second.marks);
+    m_wires.erase(it);
+}
+
+/**
+ * Adds or moves an obstacle. Paths don't go through the grid points that are covered
+ * by the rectangle, except for their first and last point.
+ * \param owner Identifies the obstacle, usually the item it belongs to
+ */
+void router::set_obstacle(const void* owner, const QRectF& rect)
+{
+    auto [it, inserted] = m_obstacles.try_emplace(owner);
+    obstacle_entry& entry = it->second;
+    if (!inserted && entry.rect == rect) {
+        return;
+    }
+
+    entry.rect = rect;
+    if (inserted || !entry.dirty) {
+        entry.dirty = true;
+        m_dirty_obstacles.push_back(owner);
+    }
+}
+
+void router::remove_obstacle(const void* owner)
+{
+    auto it = m_obstacles.find(owner);
+    if (it == m_obstacles.end()) {
+        return;
+    }
+
+    unmark_obstacle(it->second);
+    m_obstacles.erase(it);
+}
+
+int router::obstacles_count() const
+{
+    return static_cast<int>(m_obstacles.size());
+}
+
+void router::clear()
+{
+    m_tiles.clear();
+    m_wires.clear();
+    m_obstacles.clear();
+    m_dirty_wires.clear();
+    m_dirty_obstacles.clear();
+}
+
+/**
+ * Finds a path from one point to another.
+ * \param ignoredWire A wire that the path may run along, usually the one being routed
+ * \return The points after the first one up to the last one, or an empty list if there
+ *         is no path within reach
+ */
+QVector<QPointF> router::route(const QPointF& from, const QPointF& to, const wire* ignoredWire)
+{
+    update();
+
+    // Ignore the wire until it's marked again before the next search
+    if (ignoredWire) {
+        auto it = m_wires.find(ignoredWire);
+        if (it != m_wires.end() && !it->second.dirty) {
+            unmark(it->second.marks);
+            it->second.dirty = true;
+            m_dirty_wires.push_back(ignoredWire);
+        }
+    }
+
+    return search(from, to, m_state);
+}
+
+/**
+ * Finds paths for several connections at once. The connections are searched in
+ * parallel and their paths are then added in order. Paths that run along one that
+ * was added before them are searched again in the next pass. When there's no path
+ * for a connection, the paths that are in the way of the path it would have without
+ * them are ripped up to make room and searched again after it.
+ * The paths don't run along each other, except at their first and last point.
+ * \return The path of each connection, empty if none was found
+ */
+QVector<QVector<QPointF>> router::route_all(const QVector<QPair<QPointF, QPointF>>& connections, routing_report* report)
+{
+    const auto startTime = std::chrono::steady_clock::now();
+    update();
+
+    const int count = connections.count();
+    QVector<QVector<QPointF>> paths(count);
+    std::vector<std::vector<mark>> marks(count);    // The grid points each added path is marked on
+    std::vector<int> ripUps(count, 0);
+    int passes = 0;
+    int rippedUp = 0;
+
+    auto add_path = [&](int connection, const QVector<QPointF>& path) {
+        paths[connection] = path;
+        mark_path(connections.at(connection).first, path, marks[connection]);
+    };
+
+    // Removes the paths that are in the way of the path the connection would have without
+    // them. Returns false if there's nothing to remove.
+    auto rip_up = [&](int connection, QVector<int>& pending) {
+        const auto& [from, to] = connections.at(connection);
+        const auto ideal = search(from, to, m_state, false);
+        if (ideal.isEmpty()) {
+            return false;
+        }
+
+        // The grid points the ideal path runs through horizontally and vertically
+        std::unordered_set<tile_key> horizontal;
+        std::unordered_set<tile_key> vertical;
+        QPoint previous = grid_point(from);
+        const QPoint goal = grid_point(to);
+        for (const QPointF& idealPoint : ideal) {
+            const QPoint point = grid_point(idealPoint);
+            const QPoint step((point.x() > previous.x()) - (point.x() < previous.x()), (point.y() > previous.y()) - (point.y() < previous.y()));
+            for (QPoint p = previous + step; p != point + step && p != goal; p += step) {
+                (step.y() == 0 ? horizontal : vertical).insert(key(p.x(), p.y()));
+            }
+            previous = point;
+        }
+
+        bool rippedUpAny = false;
+        for (int other = 0; other < count; other++) {
+            const auto& otherMarks = marks[other];
+            const bool inTheWay = std::any_of(otherMarks.cbegin(), otherMarks.cend(), [&](const mark& mark) {
+                const tile_key pointKey = key(mark.point.x(), mark.point.y());
+                return (mark.horizontal && horizontal.count(pointKey) > 0) || (mark.vertical && vertical.count(pointKey) > 0);
+            });
+            if (inTheWay) {
+                unmark(marks[other]);
+                paths[other].clear();
+                pending << other;
+                rippedUp++;
+                rippedUpAny = true;
+            }
+        }
+        return rippedUpAny;
+    };
+
+    QVector<int> pending;
+    pending.reserve(count);
+    for (int i = 0; i < count; i++) {
+        pending << i;
+    }
+
+    while (!pending.isEmpty() && passes < MAX_ROUTING_PASSES) {
+        passes++;
+
+        // The searches only read the bitmap
+        const auto results = map_chunks<QVector<QVector<QPointF>>>(pending.count(), PARALLEL_ROUTING_CHUNK_SIZE, [&](int begin, int end) {
+            search_state state;
+            QVector<QVector<QPointF>> chunkPaths;
+            chunkPaths.reserve(end - begin);
+            for (int i = begin; i < end; i++) {
+                const auto& connection = connections.at(pending.at(i));
+                chunkPaths << search(connection.first, connection.second, state);
+            }
+            return chunkPaths;
+        });
+
+        // Add the paths in order
+        QVector<int> retry;
+        int index = 0;
+        for (const auto& chunkPaths : results) {
+            for (const auto& path : chunkPaths) {
+                const int connection = pending.at(index++);
+                if (path.isEmpty()) {
+                    // Search it again before the paths that made room for it
+                    if (ripUps[connection] < MAX_RIP_UPS) {
+                        ripUps[connection]++;
+                        retry << connection;
+                        if (!rip_up(connection, retry)) {
+                            retry.removeLast();
+                        }
+                    }
+                } else if (path_is_free(connections.at(connection).first, path)) {
+                    add_path(connection, path);
+                } else {
+                    retry << connection;
+                }
+            }
+        }
+        pending = std::move(retry);
+    }
+
+    // Search the remaining connections one after the other so that they can't conflict
+    for (int connection : pending) {
+        const auto path = search(connections.at(connection).first, connections.at(connection).second, m_state);
+        if (!path.isEmpty()) {
+            add_path(connection, path);
+        }
+    }
+
+    // The paths are only marked while routing
+    for (auto& pathMarks : marks) {
+        unmark(pathMarks);
+    }
+
+    if (report) {
+        report->connections = count;
+        report->routed = static_cast<int>(std::count_if(paths.cbegin(), paths.cend(), [](const QVector<QPointF>& path) {
+            return !path.isEmpty();
+        }));
+        report->passes = passes;
+        report->ripped_up = rippedUp;
+        report->seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - startTime).count();
+    }
+
+    return paths;
+}
+
+/**
+ * Searches a path in the bitmap as it is. This doesn't modify the router so several
+ * searches can run at the same time with their own state.
+ * \param avoidPaths Whether the paths of route_all() are avoided like wires
+ */
+QVector<QPointF> router::search(const QPointF& from, const QPointF& to, search_state& scratch, bool avoidPaths) const
+{
+    const QPoint start = grid_point(from);
+    const QPoint goal = grid_point(to);
+    if (start == goal) {
+        return { to };
+    }
+
+    // The area that is searched
+    QRect window(QPoint(std::min(start.x(), goal.x()), std::min(start.y(), goal.y())),
+                 QPoint(std::max(start.x(), goal.x()), std::max(start.y(), goal.y())));
+    const int margin = WINDOW_MARGIN + std::max(window.width(), window.height()) / 2;
+    window.adjust(-margin, -margin, margin, margin);
+    if (window.width() > MAX_WINDOW_SIZE || window.height() > MAX_WINDOW_SIZE) {
+        return { };
+    }
+
+    // The flags are copied from the tiles the first time the search reaches them
+    const int width = window.width();
+    const int statesCount = width * window.height() * 4;
+    scratch.window.assign(width * window.height(), NOT_LOADED);
+
+    // The costs of the previous searches are recognized by their stamp so they don't have to be reset
+    if (scratch.stamps.size() < static_cast<std::size_t>(statesCount)) {
+        scratch.stamps.resize(statesCount, 0);
+        scratch.costs.resize(statesCount);
+        scratch.parents.resize(statesCount);
+    }
+    if (++scratch.search == 0) {
+        std::fill(scratch.stamps.begin(), scratch.stamps.end(), 0);
+        scratch.search = 1;
+    }
+    scratch.open.clear();
+
+    auto state_of = [&](int x, int y, int direction) {
+        return ((y - window.top()) * width + (x - window.left())) * 4 + direction;
+    };
+    auto heuristic = [&](int x, int y, int direction) {
+        const int dx = goal.x() - x;
+        const int dy = goal.y() - y;
+        return BEND_COST * min_bends(direction, dx, dy) + std::abs(dx) + std::abs(dy);
+    };
+    auto flags_at = [&](int x, int y) {
+        const quint8& flags = scratch.window[(y - window.top()) * width + (x - window.left())];
+        if (flags & NOT_LOADED) {
+            load_tile(window, tile_coordinate(x, TILE_SIZE), tile_coordinate(y, TILE_SIZE), scratch.window, avoidPaths);
+        }
+        return flags;
+    };
+    auto can_enter = [&](int x, int y, int direction) {
+        if (!window.contains(x, y)) {
+            return false;
+        }
+        if (x == goal.x() && y == goal.y()) {
+            return true;
+        }
+        const quint8 flags = flags_at(x, y);
+        return !(flags & BLOCKED) && !(flags & (direction % 2 == 0 ? HORIZONTAL : VERTICAL));
+    };
+    auto enclosed = [&](const QPoint& point) {
+        for (int direction = 0; direction < 4; direction++) {
+            const int x = point.x() + DIRECTION_X[direction];
+            const int y = point.y() + DIRECTION_Y[direction];
+            if (!(flags_at(x, y) & BLOCKED)) {
+                return false;
+            }
+        }
+        return true;
+    };
+    auto push = [&](int x, int y, int direction, qint64 cost, int parent) {
+        const int state = state_of(x, y, direction);
+        if (scratch.stamps[state] == scratch.search && cost >= scratch.costs[state]) {
+            return;
+        }
+        scratch.stamps[state] = scratch.search;
+        scratch.costs[state] = cost;
+        scratch.parents[state] = parent;
+        scratch.open.emplace_back(cost + heuristic(x, y, direction), state);
+        std::push_heap(scratch.open.begin(), scratch.open.end(), std::greater<>());
+    };
+
+    // Don't search the whole window for points that are inside of an obstacle
+    if (enclosed(start) || enclosed(goal)) {
+        return { };
+    }
+
+    // The first step can go in any direction without bending
+    for (int direction = 0; direction < 4; direction++) {
+        const int x = start.x() + DIRECTION_X[direction];
+        const int y = start.y() + DIRECTION_Y[direction];
+        if (can_enter(x, y, direction)) {
+            push(x, y, direction, 1, -1);
+        }
+    }
+
+    int found = -1;
+    int expansions = 0;
+    while (!scratch.open.empty() && expansions < MAX_EXPANSIONS) {
+        std::pop_heap(scratch.open.begin(), scratch.open.end(), std::greater<>());
+        const auto [estimate, state] = scratch.open.back();
+        scratch.open.pop_back();
+
+        const int direction = state % 4;
+        const int x = window.left() + (state / 4) % width;
+        const int y = window.top() + (state / 4) / width;
+        const qint64 cost = scratch.costs[state];
+
+        // Skip the entries that have been superseded by a cheaper one
+        if (estimate != cost + heuristic(x, y, direction)) {
+            continue;
+        }
+        if (x == goal.x() && y == goal.y()) {
+            found = state;
+            break;
+        }
+        expansions++;
+
+        for (int newDirection = 0; newDirection < 4; newDirection++) {
+            // Don't go back
+            if (newDirection == (direction + 2) % 4) {
+                continue;
+            }
+            const int newX = x + DIRECTION_X[newDirection];
+            const int newY = y + DIRECTION_Y[newDirection];
+            if (can_enter(newX, newY, newDirection)) {
+                push(newX, newY, newDirection, cost + 1 + (newDirection != direction ? BEND_COST : 0), state);
+            }
+        }
+    }
+
+    if (found < 0) {
+        return { };
+    }
+
+    // Walk back from the goal and keep the points where the direction changes
+    QVector<QPointF> points;
+    points.append(to);
+    for (int state = found; scratch.parents[state] >= 0; state = scratch.parents[state]) {
+        const int parent = scratch.parents[state];
+        if (parent % 4 != state % 4) {
+            const int x = window.left() + (parent / 4) % width;
+            const int y = window.top() + (parent / 4) / width;
+            points.append(QPointF(x * m_grid_size, y * m_grid_size));
+        }
+    }
+    std::reverse(points.begin(), points.end());
+
+    return points;
+}
+
+/**
+ * Applies the changes of the obstacles and wires to the bitmap
+ */
+void router::update()
+{
+    for (const void* owner : m_dirty_obstacles) {
+        auto it = m_obstacles.find(owner);
+        // Skip obstacles that have been removed in the meantime
+        if (it == m_obstacles.end() || !it->second.dirty) {
+            continue;
+        }
+
+        unmark_obstacle(it->second);
+        mark_obstacle(it->second);
+        it->second.dirty = false;
+    }
+    m_dirty_obstacles.clear();
+
+    for (const wire* wire : m_dirty_wires) {
+        auto it = m_wires.find(wire);
+        // Skip wires that have been removed in the meantime
+        if (it == m_wires.end() || !it->second.dirty) {
+            continue;
+        }
+
+        wire_entry& entry = it->second;
+        unmark(entry.marks);
+        entry.dirty = false;
+
+        // Forget about wires that no longer exist
+        auto shared = entry.ref.lock();
+        if (!shared) {
+            m_wires.erase(it);
+            continue;
+        }
+
+        mark_wire(shared.get(), entry);
+    }
+    m_dirty_wires.clear();
+}
+
+/**
+ * Returns whether the path still doesn't run along any of the marked wires or paths
+ */
+bool router::path_is_free(const QPointF& from, const QVector<QPointF>& path) const
+{
+    QPoint previous = grid_point(from);
+    const QPoint goal = grid_point(path.last());
+    for (const QPointF& pathPoint : path) {
+        const QPoint point = grid_point(pathPoint);
+        const QPoint step((point.x() > previous.x()) - (point.x() < previous.x()), (point.y() > previous.y()) - (point.y() < previous.y()));
+        const bool horizontal = step.y() == 0;
+        for (QPoint p = previous + step; p != point + step; p += step) {
+            if (p == goal) {
+                break;
+            }
+            const cell* cell = find_cell(p);
+            if (cell && (horizontal ? cell->horizontal + cell->paths_horizontal : cell->vertical + cell->paths_vertical) > 0) {
+                return false;
+            }
+        }
+        previous = point;
+    }
+    return true;
+}
+
+void router::mark_wire(wire* wire, wire_entry& entry)
+{
+    const auto& points = wire->points();
+    if (points.isEmpty()) {
+        return;
+    }
+
+    for (int i = 0; i < points.count() - 1; i++) {
+        mark_segment(grid_point(points.at(i).toPointF()), grid_point(points.at(i + 1).toPointF()), false, entry.marks);
+    }
+
+    // Paths that go through the ends of the wire would get connected to it
+    mark_point(grid_point(points.first().toPointF()), true, true, false, entry.marks);
+    mark_point(grid_point(points.last().toPointF()), true, true, false, entry.marks);
+}
+
+/**
+ * Marks a path found by route_all() like a wire going through its points
+ */
+void router::mark_path(const QPointF& from, const QVector<QPointF>& path, std::vector<mark>& marks)
+{
+    QPoint previous = grid_point(from);
+    for (const QPointF& point : path) {
+        mark_segment(previous, grid_point(point), true, marks);
+        previous = grid_point(point);
+    }
+
+    mark_point(grid_point(from), true, true, true, marks);
+    mark_point(previous, true, true, true, marks);
+}
+
+void router::mark_segment(const QPoint& a, const QPoint& b, bool path, std::vector<mark>& marks)
+{
+    const bool horizontal = a.y() == b.y();
+    const bool vertical = a.x() == b.x();
+
+    // Paths can't cross segments that aren't straight at all
+    const int steps = std::max(std::abs(b.x() - a.x()), std::abs(b.y() - a.y()));
+    for (int step = 0; step <= steps; step++) {
+        const QPoint point = steps == 0 ? a : a + QPoint(qRound(qreal(b.x() - a.x()) * step / steps),
+                                                         qRound(qreal(b.y() - a.y()) * step / steps));
+        mark_point(point, horizontal || !vertical, vertical || !horizontal, path, marks);
+    }
+}
+
+void router::mark_point(const QPoint& point, bool horizontal, bool vertical, bool path, std::vector<mark>& marks)
+{
+    cell& cell = cell_at(point);
+    (path ? cell.paths_horizontal : cell.horizontal) += horizontal ? 1 : 0;
+    (path ? cell.paths_vertical : cell.vertical) += vertical ? 1 : 0;
+    marks.push_back({ point, horizontal, vertical, path });
+}
+
+void router::unmark(std::vector<mark>& marks)
+{
+    for (const auto& mark : marks) {
+        cell& cell = cell_at(mark.point);
+        (mark.path ? cell.paths_horizontal : cell.horizontal) -= mark.horizontal ? 1 : 0;
+        (mark.path ? cell.paths_vertical : cell.vertical) -= mark.vertical ? 1 : 0;
+    }
+    marks.clear();
+}
+
+void router::mark_obstacle(obstacle_entry& entry)
+{
+    // The grid points that are inside of the rectangle or on its outline
+    const QRectF& rect = entry.rect;
+    const QPoint topLeft(static_cast<int>(std::ceil(rect.left() / m_grid_size)), static_cast<int>(std::ceil(rect.top() / m_grid_size)));
+    const QPoint bottomRight(static_cast<int>(std::floor(rect.right() / m_grid_size)), static_cast<int>(std::floor(rect.bottom() / m_grid_size)));
+    entry.marked = QRect(topLeft, bottomRight);
+    if (!entry.marked.isValid()) {
+        entry.marked = QRect();
+        return;
+    }
+
+    for (int y = entry.marked.top(); y <= entry.marked.bottom(); y++) {
+        for (int x = entry.marked.left(); x <= entry.marked.right(); x++) {
+            cell_at({ x, y }).obstacles++;
+        }
+    }
+}
+
+void router::unmark_obstacle(obstacle_entry& entry)
+{
+    if (entry.marked.isNull()) {
+        return;
+    }
+
+    for (int y = entry.marked.top(); y <= entry.marked.bottom(); y++) {
+        for (int x = entry.marked.left(); x <= entry.marked.right(); x++) {
+            cell_at({ x, y }).obstacles--;
+        }
+    }
+    entry.marked = QRect();
+}
+
+router::cell& router::cell_at(const QPoint& point)
+{
+    const int tileX = tile_coordinate(point.x(), TILE_SIZE);
+    const int tileY = tile_coordinate(point.y(), TILE_SIZE);
+    tile& tile = m_tiles[key(tileX, tileY)];
+    return tile[(point.y() - tileY * TILE_SIZE) * TILE_SIZE + (point.x() - tileX * TILE_SIZE)];
+}
+
+/**
+ * Returns the cell of the grid point or nullptr if nothing has ever been marked in its tile
+ */
+const router::cell* router::find_cell(const QPoint& point) const
+{
+    const int tileX = tile_coordinate(point.x(), TILE_SIZE);
+    const int tileY = tile_coordinate(point.y(), TILE_SIZE);
+    const auto it = m_tiles.find(key(tileX, tileY));
+    if (it == m_tiles.end()) {
+        return nullptr;
+    }
+    return &it->second[(point.y() - tileY * TILE_SIZE) * TILE_SIZE + (point.x() - tileX * TILE_SIZE)];
+}
+
+QPoint router::grid_point(const QPointF& point) const
+{
+    return { qRound(point.x() / m_grid_size), qRound(point.y() / m_grid_size) };
+}
+
+router::tile_key router::key(int x, int y)
+{
+    return (static_cast<tile_key>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y);
+}
+
+/**
+ * Copies the flags of the grid points of the window that are in the tile
+ */
+void router::load_tile(const QRect& window, int tileX, int tileY, std::vector<quint8>& flags, bool withPaths) const
+{
+    const int width = window.width();
+    const auto it = m_tiles.find(key(tileX, tileY));
+
+    // The part of the tile that is in the window
+    const QRect area = window.intersected(QRect(tileX * TILE_SIZE, tileY * TILE_SIZE, TILE_SIZE, TILE_SIZE));
+    for (int y = area.top(); y <= area.bottom(); y++) {
+        quint8* rowFlags = &flags[(y - window.top()) * width];
+        if (it == m_tiles.end()) {
+            std::fill(rowFlags + area.left() - window.left(), rowFlags + area.right() + 1 - window.left(), 0);
+            continue;
+        }
+        const cell* row = &it->second[(y - tileY * TILE_SIZE) * TILE_SIZE];
+        for (int x = area.left(); x <= area.right(); x++) {
+            const cell& cell = row[x - tileX * TILE_SIZE];
+            const int horizontal = cell.horizontal + (withPaths ? cell.paths_horizontal : 0);
+            const int vertical = cell.vertical + (withPaths ? cell.paths_vertical : 0);
+            rowFlags[x - window.left()] = (cell.obstacles > 0 ? BLOCKED : 0) |
+                                          (horizontal > 0 ? HORIZONTAL : 0) |
+                                          (vertical > 0 ? VERTICAL : 0);
+        }
+    }
+}
@@ -0,0 +1,141 @@
+#pragma once
+
+#include <QtGlobal>
+#include <QPoint>
+#include <QPointF>
+#include <QRect>
+#include <QRectF>
+#include <QPair>
+#include <QVector>
+
+#include <array>
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace wire_system
+{
+    class wire;
+
+    /**
+     * Describes how routing several connections at once went
+     */
+    struct routing_report
+    {
+        int connections = 0;
+        int routed = 0;                 // The connections for which a path was found
+        int passes = 0;                 // The number of times the pending connections were searched in parallel
+        int ripped_up = 0;              // The number of paths that were removed to make room for other ones
+        double seconds = 0;
+
+        [[nodiscard]] double connections_per_second() const;
+    };
+
+    /**
+     * Finds orthogonal paths on the grid that go around obstacles and don't run along
+     * existing wires. The path with the fewest bends is chosen, and the shortest one among
+     * those.
+     * The obstacles and the wires are marked on the grid points of a tiled bitmap. Like
+     * in the spatial index this is done lazily: changing them only marks them as dirty
+     * and the bitmap is updated right before the next search.
+     * route_all() routes several connections at once by searching them on worker threads
+     * while the bitmap isn't modified.
+     * \remark Wires need to be removed from the router before they get destroyed.
+     */
+    class router
+    {
+    public:
+        router();
+        router(const router& other) = delete;
+        router(router&& other) = delete;
+        ~router() = default;
+
+        router& operator=(const router& rhs) = delete;
+        router& operator=(router&& rhs) = delete;
+
+        void set_grid_size(int size);
+        [[nodiscard]] int grid_size() const;
+        void insert(const std::shared_ptr<wire>& wire);
+        void invalidate(const wire* wire);
+        void remove(const wire* wire);
+        void set_obstacle(const void* owner, const QRectF& rect);
+        void remove_obstacle(const void* owner);
+        [[nodiscard]] int obstacles_count() const;
+        void clear();
+        [[nodiscard]] QVector<QPointF> route(const QPointF& from, const QPointF& to, const wire* ignoredWire = nullptr);
+        [[nodiscard]] QVector<QVector<QPointF>> route_all(const QVector<QPair<QPointF, QPointF>>& connections, routing_report* report = nullptr);
+
+    private:
+        struct cell
+        {
+            quint16 obstacles = 0;      // The number of obstacles that cover the grid point
+            quint16 horizontal = 0;     // The number of wires that run horizontally through the grid point
+            quint16 vertical = 0;
+            quint16 paths_horizontal = 0;   // The same for the paths found by route_all() that is running
+            quint16 paths_vertical = 0;
+        };
+
+        static constexpr int TILE_SIZE = 64;
+        using tile = std::array<cell, TILE_SIZE * TILE_SIZE>;
+        using tile_key = quint64;
+
+        struct mark
+        {
+            QPoint point;
+            bool horizontal;
+            bool vertical;
+            bool path;                  // Whether the mark belongs to a path found by route_all()
+        };
+
+        struct wire_entry
+        {
+            std::weak_ptr<wire> ref;
+            std::vector<mark> marks;    // The grid points the wire is marked on
+            bool dirty = true;
+        };
+
+        struct obstacle_entry
+        {
+            QRectF rect;
+            QRect marked;               // The grid points the obstacle is marked on, null if none
+            bool dirty = true;
+        };
+
+        // Scratch buffers of a search, reused to avoid allocating
+        struct search_state
+        {
+            std::vector<quint8> window;
+            std::vector<quint32> stamps;    // The search in which the cost of each state was set
+            std::vector<qint64> costs;
+            std::vector<int> parents;
+            std::vector<std::pair<qint64, int>> open;
+            quint32 search = 0;
+        };
+
+        void update();
+        [[nodiscard]] QVector<QPointF> search(const QPointF& from, const QPointF& to, search_state& state, bool avoidPaths = true) const;
+        [[nodiscard]] bool path_is_free(const QPointF& from, const QVector<QPointF>& path) const;
+        void mark_wire(wire* wire, wire_entry& entry);
+        void mark_path(const QPointF& from, const QVector<QPointF>& path, std::vector<mark>& marks);
+        void mark_segment(const QPoint& a, const QPoint& b, bool path, std::vector<mark>& marks);
+        void mark_point(const QPoint& point, bool horizontal, bool vertical, bool path, std::vector<mark>& marks);
+        void unmark(std::vector<mark>& marks);
+        void mark_obstacle(obstacle_entry& entry);
+        void unmark_obstacle(obstacle_entry& entry);
+        [[nodiscard]] cell& cell_at(const QPoint& point);
+        [[nodiscard]] const cell* find_cell(const QPoint& point) const;
+        [[nodiscard]] QPoint grid_point(const QPointF& point) const;
+        [[nodiscard]] static tile_key key(int x, int y);
+        void load_tile(const QRect& window, int tileX, int tileY, std::vector<quint8>& flags, bool withPaths) const;
+
+        int m_grid_size;
+        std::unordered_map<tile_key, tile> m_tiles;
+        std::unordered_map<const wire*, wire_entry> m_wires;
+        std::unordered_map<const void*, obstacle_entry> m_obstacles;
+        std::vector<const wire*> m_dirty_wires;
+        std::vector<const void*> m_dirty_obstacles;
+        search_state m_state;               // Used by route()
+    };
+
+}
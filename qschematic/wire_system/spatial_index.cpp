@@ -0,0 +1,233 @@
+#include "spatial_index.h"
+#include "wire.h"
+
+#include <algorithm>
+#include <cmath>
+
+using namespace wire_system;
+
+// The segments are stored in every cell that they cross when they are grown by this margin.
+// This has to be larger than the tolerances used when looking up points on segments.
+const qreal SEGMENT_MARGIN = 1.0;
+const qreal DEFAULT_CELL_SIZE = 80;
+
+spatial_index::spatial_index() :
+    m_cell_size(DEFAULT_CELL_SIZE)
+{
+}
+
+/**
+ * Changes the size of the cells. This re-indexes all the wires.
+ */
+void spatial_index::set_cell_size(qreal size)
+{
+    if (size <= 0) {
+        size = DEFAULT_CELL_SIZE;
+    }
+    if (qFuzzyCompare(size, m_cell_size)) {
+        return;
+    }
+
+    m_cell_size = size;
+
+    // The cells are no longer valid
+    m_cells.clear();
+    m_dirty.clear();
+    for (auto& [wire, entry] : m_wires) {
+        entry.cells.clear();
+        entry.dirty = true;
+        m_dirty.push_back(wire);
+    }
+}
+
+qreal spatial_index::cell_size() const
+{
+    return m_cell_size;
+}
+
+/**
+ * Adds a wire to the index. Nothing happens if the wire is already indexed.
+ */
+void spatial_index::insert(const std::shared_ptr<wire>& wire)
+{
+    if (!wire || contains(wire.get())) {
+        return;
+    }
+
+    entry& entry = m_wires[wire.get()];
+    entry.ref = wire;
+    entry.dirty = true;
+    m_dirty.push_back(wire.get());
+}
+
+/**
+ * Marks the wire's segments as outdated. They will be re-indexed before the next query.
+ */
+void spatial_index::invalidate(const wire* wire)
+{
+    auto it = m_wires.find(wire);
+    if (it == m_wires.end() || it->second.dirty) {
+        return;
+    }
+
+    it->second.dirty = true;
+    m_dirty.push_back(wire);
+}
+
+void spatial_index::remove(const wire* wire)
+{
+    auto it = m_wires.find(wire);
+    if (it == m_wires.end()) {
+        return;
+    }
+
+    // Dirty entries are skipped once they are no longer in the map
+    unindex_wire(wire, it->second);
+    m_wires.erase(it);
+}
+
+void spatial_index::clear()
+{
+    m_cells.clear();
+    m_wires.clear();
+    m_dirty.clear();
+}
+
+bool spatial_index::contains(const wire* wire) const
+{
+    return m_wires.find(wire) != m_wires.end();
+}
+
+/**
+ * Returns the shared pointer of an indexed wire or nullptr if the wire isn't indexed
+ */
+std::shared_ptr<wire> spatial_index::shared_wire(const wire* wire) const
+{
+    auto it = m_wires.find(wire);
+    if (it == m_wires.end()) {
+        return nullptr;
+    }
+
+    return it->second.ref.lock();
+}
+
+int spatial_index::wires_count() const
+{
+    return static_cast<int>(m_wires.size());
+}
+
+int spatial_index::cell_coordinate(qreal value) const
+{
+    return static_cast<int>(std::floor(value / m_cell_size));
+}
+
+spatial_index::cell_key spatial_index::key_at(const QPointF& point) const
+{
+    return key(cell_coordinate(point.x()), cell_coordinate(point.y()));
+}
+
+spatial_index::cell_key spatial_index::key(int x, int y)
+{
+    return (static_cast<cell_key>(static_cast<quint32>(x)) << 32) | static_cast<quint32>(y);
+}
+
+/**
+ * Re-indexes the wires that changed since the last query
+ */
+void spatial_index::update()
+{
+    for (const wire* wire : m_dirty) {
+        auto it = m_wires.find(wire);
+        // Skip wires that have been removed in the meantime
+        if (it == m_wires.end() || !it->second.dirty) {
+            continue;
+        }
+
+        entry& entry = it->second;
+        unindex_wire(wire, entry);
+        entry.dirty = false;
+
+        // Forget about wires that no longer exist
+        auto shared = entry.ref.lock();
+        if (!shared) {
+            m_wires.erase(it);
+            continue;
+        }
+
+        index_wire(shared.get(), entry);
+    }
+    m_dirty.clear();
+}
+
+void spatial_index::index_wire(wire* wire, entry& entry)
+{
+    const auto& points = wire->points();
+
+    // A single point still needs to be found by its position
+    if (points.count() == 1) {
+        const QPointF p = points.first().toPointF();
+        add_segment(entry, { wire, -1, line(p, p) });
+    }
+
+    for (int i = 0; i < points.count() - 1; i++) {
+        add_segment(entry, { wire, i, line(points.at(i).toPointF(), points.at(i + 1).toPointF()) });
+    }
+
+    // Segments of the same wire often share cells
+    std::sort(entry.cells.begin(), entry.cells.end());
+    entry.cells.erase(std::unique(entry.cells.begin(), entry.cells.end()), entry.cells.end());
+}
+
+void spatial_index::unindex_wire(const wire* wire, entry& entry)
+{
+    for (const cell_key key : entry.cells) {
+        auto it = m_cells.find(key);
+        if (it == m_cells.end()) {
+            continue;
+        }
+        // Empty cells are kept around so that moving wires back and forth doesn't allocate
+        auto& segments = it->second;
+        segments.erase(std::remove_if(segments.begin(), segments.end(), [wire](const segment& segment) {
+            return segment.owner == wire;
+        }), segments.end());
+    }
+    entry.cells.clear();
+}
+
+/**
+ * Adds the segment to the cells that it crosses. The columns of cells that the segment
+ * spans are walked one after the other and in each column only the rows between the
+ * heights of the segment at the column's borders are added, so a diagonal segment is only
+ * added to the cells along it instead of all the cells of its bounding box.
+ */
+void spatial_index::add_segment(entry& entry, const segment& segment)
+{
+    const QPointF& p1 = segment.geometry.p1();
+    const QPointF& p2 = segment.geometry.p2();
+    const qreal left = qMin(p1.x(), p2.x());
+    const qreal right = qMax(p1.x(), p2.x());
+    const qreal dx = p2.x() - p1.x();
+    const qreal slope = qFuzzyIsNull(dx) ? 0 : (p2.y() - p1.y()) / dx;
+
+    const int x1 = cell_coordinate(left - SEGMENT_MARGIN);
+    const int x2 = cell_coordinate(right + SEGMENT_MARGIN);
+    for (int x = x1; x <= x2; x++) {
+        // The heights of the segment where it enters and leaves the column (grown by the margin)
+        qreal ya = p1.y();
+        qreal yb = p2.y();
+        if (!qFuzzyIsNull(dx)) {
+            const qreal from = qMax(left, x * m_cell_size - SEGMENT_MARGIN);
+            const qreal to = qMin(right, (x + 1) * m_cell_size + SEGMENT_MARGIN);
+            ya = p1.y() + (from - p1.x()) * slope;
+            yb = p1.y() + (to - p1.x()) * slope;
+        }
+
+        const int y1 = cell_coordinate(qMin(ya, yb) - SEGMENT_MARGIN);
+        const int y2 = cell_coordinate(qMax(ya, yb) + SEGMENT_MARGIN);
+        for (int y = y1; y <= y2; y++) {
+            const cell_key cellKey = key(x, y);
+            m_cells[cellKey].push_back(segment);
+            entry.cells.push_back(cellKey);
+        }
+    }
+}
@@ -0,0 +1,132 @@
+#pragma once
+
+#include "line.h"
+
+#include <QtGlobal>
+#include <QPointF>
+
+#include <memory>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace wire_system
+{
+    class wire;
+
+    /**
+     * A uniform grid of the line segments of all the wires known to the manager.
+     * Wires are re-indexed lazily: invalidating a wire only marks it as dirty and the
+     * actual work is done once right before the next query.
+     * \remark Wires need to be removed from the index before they get destroyed.
+     */
+    class spatial_index
+    {
+    public:
+        struct segment
+        {
+            wire* owner;
+            int index;          // Index of the segment in the wire or -1 if the wire consists of a single point
+            line geometry;
+        };
+
+        spatial_index();
+        spatial_index(const spatial_index& other) = delete;
+        spatial_index(spatial_index&& other) = delete;
+        ~spatial_index() = default;
+
+        spatial_index& operator=(const spatial_index& rhs) = delete;
+        spatial_index& operator=(spatial_index&& rhs) = delete;
+
+        void set_cell_size(qreal size);
+        [[nodiscard]] qreal cell_size() const;
+        void insert(const std::shared_ptr<wire>& wire);
+        void invalidate(const wire* wire);
+        void remove(const wire* wire);
+        void clear();
+        [[nodiscard]] bool contains(const wire* wire) const;
+        [[nodiscard]] std::shared_ptr<wire> shared_wire(const wire* wire) const;
+        [[nodiscard]] int wires_count() const;
+        void update();
+
+        /**
+         * Calls the visitor for every segment indexed in the cell that contains the point.
+         * The visitor returns whether the iteration should continue.
+         * \remark The visitor must not modify the wires.
+         */
+        template<typename Visitor>
+        void for_each_segment_near(const QPointF& point, Visitor&& visitor)
+        {
+            update();
+            for_each_indexed_segment_near(point, std::forward<Visitor>(visitor));
+        }
+
+        /**
+         * Same as for_each_segment_near() but the wires that changed are not re-indexed.
+         * This can be called from several threads at once after calling update().
+         */
+        template<typename Visitor>
+        void for_each_indexed_segment_near(const QPointF& point, Visitor&& visitor) const
+        {
+            const auto it = m_cells.find(key_at(point));
+            if (it == m_cells.end()) {
+                return;
+            }
+            for (const segment& segment : it->second) {
+                if (!visitor(segment)) {
+                    return;
+                }
+            }
+        }
+
+        /**
+         * Calls the visitor for every segment indexed in the cells that a wire occupies,
+         * including the segments of the wire itself.
+         * The visitor returns whether the iteration should continue.
+         * \remark The visitor must not modify the wires.
+         */
+        template<typename Visitor>
+        void for_each_segment_near_wire(const wire* wire, Visitor&& visitor)
+        {
+            update();
+            const auto it = m_wires.find(wire);
+            if (it == m_wires.end()) {
+                return;
+            }
+            for (const cell_key key : it->second.cells) {
+                const auto cell = m_cells.find(key);
+                if (cell == m_cells.end()) {
+                    continue;
+                }
+                for (const segment& segment : cell->second) {
+                    if (!visitor(segment)) {
+                        return;
+                    }
+                }
+            }
+        }
+
+    private:
+        using cell_key = quint64;
+
+        struct entry
+        {
+            std::weak_ptr<wire> ref;
+            std::vector<cell_key> cells;
+            bool dirty = true;
+        };
+
+        [[nodiscard]] int cell_coordinate(qreal value) const;
+        [[nodiscard]] cell_key key_at(const QPointF& point) const;
+        [[nodiscard]] static cell_key key(int x, int y);
+        void index_wire(wire* wire, entry& entry);
+        void unindex_wire(const wire* wire, entry& entry);
+        void add_segment(entry& entry, const segment& segment);
+
+        qreal m_cell_size;
+        std::unordered_map<cell_key, std::vector<segment>> m_cells;
+        std::unordered_map<const wire*, entry> m_wires;
+        std::vector<const wire*> m_dirty;
+    };
+
+}
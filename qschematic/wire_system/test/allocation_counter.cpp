@@ -0,0 +1,44 @@
+#include "allocation_counter.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <new>
+
+namespace
+{
+    std::atomic<bool> counting(false);
+    std::atomic<int> count(0);
+}
+
+void allocations::start_counting()
+{
+    count = 0;
+    counting = true;
+}
+
+int allocations::stop_counting()
+{
+    counting = false;
+    return count;
+}
+
+void* operator new(std::size_t size)
+{
+    if (counting) {
+        count++;
+    }
+    if (void* ptr = std::malloc(size ? size : 1)) {
+        return ptr;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* ptr) noexcept
+{
+    std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+    std::free(ptr);
+}
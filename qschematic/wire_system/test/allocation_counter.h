@@ -0,0 +1,11 @@
+#pragma once
+
+/**
+ * Counts the heap allocations made by the test executable. The global operator new
+ * is replaced to do so.
+ */
+namespace allocations
+{
+    void start_counting();
+    [[nodiscard]] int stop_counting();
+}
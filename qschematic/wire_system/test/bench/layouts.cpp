@@ -0,0 +1,159 @@
+#include "layouts.h"
+#include "../../wire.h"
+
+#include <QPointF>
+
+#include <cmath>
+
+using namespace bench;
+
+namespace
+{
+    std::shared_ptr<wire_system::wire> create_wire(std::initializer_list<QPointF> points)
+    {
+        auto wire = std::make_shared<wire_system::wire>();
+        for (const auto& point : points) {
+            wire->append_point(point);
+        }
+        return wire;
+    }
+
+    /**
+     * Adds the wire to the list and returns the number of segments it has
+     */
+    int add(wire_list& wires, std::shared_ptr<wire_system::wire>&& wire)
+    {
+        const int count = wire->points_count() - 1;
+        wires.append(std::move(wire));
+        return count;
+    }
+}
+
+/**
+ * Horizontal rails with vertical rungs between them. Every rung ends on two rails.
+ */
+wire_list bench::grid(int segments, int gridSize, std::mt19937& random)
+{
+    Q_UNUSED(random)
+
+    const int side = std::max(1, static_cast<int>(std::ceil(std::sqrt(segments))));
+    const qreal step = 2 * gridSize;
+
+    wire_list wires;
+    int count = 0;
+    for (int row = 0; row <= side && count < segments; row++) {
+        count += add(wires, create_wire({ { 0, row * step }, { side * step, row * step } }));
+    }
+    for (int row = 0; row < side && count < segments; row++) {
+        for (int column = 0; column < side && count < segments; column++) {
+            const qreal x = column * step + gridSize;
+            count += add(wires, create_wire({ { x, row * step }, { x, (row + 1) * step } }));
+        }
+    }
+
+    return wires;
+}
+
+/**
+ * Long horizontal buses with up to a thousand L-shaped branches ending on each of them
+ */
+wire_list bench::buses(int segments, int gridSize, std::mt19937& random)
+{
+    Q_UNUSED(random)
+
+    const int branchesPerBus = std::clamp(segments / 2, 1, 1000);
+    const qreal step = 2 * gridSize;
+
+    wire_list wires;
+    int count = 0;
+    for (int bus = 0; count < segments; bus++) {
+        const qreal y = bus * 10 * gridSize;
+        count += add(wires, create_wire({ { 0, y }, { branchesPerBus * step, y } }));
+        for (int branch = 0; branch < branchesPerBus && count < segments; branch++) {
+            const qreal x = branch * step + gridSize;
+            count += add(wires, create_wire({ { x + gridSize, y + 4 * gridSize }, { x, y + 4 * gridSize }, { x, y } }));
+        }
+    }
+
+    return wires;
+}
+
+/**
+ * Nets made of eight L-shaped spokes that all start at the same center point
+ */
+wire_list bench::stars(int segments, int gridSize, std::mt19937& random)
+{
+    Q_UNUSED(random)
+
+    const int starsCount = std::max(1, segments / 16);
+    const int columns = std::max(1, static_cast<int>(std::ceil(std::sqrt(starsCount))));
+    const qreal spacing = 20 * gridSize;
+    const QPointF directions[4] = { { 1, 0 }, { 0, 1 }, { -1, 0 }, { 0, -1 } };
+
+    wire_list wires;
+    int count = 0;
+    for (int star = 0; count < segments; star++) {
+        const QPointF center((star % columns) * spacing, (star / columns) * spacing);
+        for (const auto& direction : directions) {
+            const QPointF corner = center + direction * 4 * gridSize;
+            const QPointF perpendicular(direction.y(), direction.x());
+            count += add(wires, create_wire({ center, corner, corner + perpendicular * 2 * gridSize }));
+            count += add(wires, create_wire({ center, corner, corner - perpendicular * 2 * gridSize }));
+        }
+    }
+
+    return wires;
+}
+
+/**
+ * Wires with one to three segments of random lengths and directions. Some of them
+ * end on other wires by chance.
+ */
+wire_list bench::manhattan(int segments, int gridSize, std::mt19937& random)
+{
+    const int cells = std::max(10, static_cast<int>(std::sqrt(segments)) * 4);
+    std::uniform_int_distribution<int> position(0, cells);
+    std::uniform_int_distribution<int> segmentsPerWire(1, 3);
+    std::uniform_int_distribution<int> length(1, 8);
+    std::bernoulli_distribution coin;
+
+    wire_list wires;
+    int count = 0;
+    while (count < segments) {
+        auto wire = std::make_shared<wire_system::wire>();
+        QPointF point(position(random) * gridSize, position(random) * gridSize);
+        wire->append_point(point);
+
+        bool horizontal = coin(random);
+        const int wireSegments = segmentsPerWire(random);
+        for (int i = 0; i < wireSegments; i++) {
+            const qreal distance = length(random) * gridSize * (coin(random) ? 1 : -1);
+            point += horizontal ? QPointF(distance, 0) : QPointF(0, distance);
+            wire->append_point(point);
+            horizontal = !horizontal;
+        }
+
+        count += add(wires, std::move(wire));
+    }
+
+    return wires;
+}
+
+QVector<layout> bench::layouts()
+{
+    return {
+        { "grid", grid },
+        { "buses", buses },
+        { "stars", stars },
+        { "manhattan", manhattan },
+    };
+}
+
+int bench::segments_count(const wire_list& wires)
+{
+    int count = 0;
+    for (const auto& wire : wires) {
+        count += wire->points_count() - 1;
+    }
+    return count;
+}
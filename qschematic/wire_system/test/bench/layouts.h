@@ -0,0 +1,36 @@
+#pragma once
+
+#include <QString>
+#include <QVector>
+
+#include <functional>
+#include <memory>
+#include <random>
+
+namespace wire_system
+{
+    class wire;
+}
+
+namespace bench
+{
+    using wire_list = QVector<std::shared_ptr<wire_system::wire>>;
+    using generator = std::function<wire_list(int segments, int gridSize, std::mt19937& random)>;
+
+    /**
+     * A synthetic layout. The generator creates wires with about the requested
+     * number of segments. The wires are not added to a manager.
+     */
+    struct layout
+    {
+        QString name;
+        generator generate;
+    };
+
+    [[nodiscard]] wire_list grid(int segments, int gridSize, std::mt19937& random);
+    [[nodiscard]] wire_list buses(int segments, int gridSize, std::mt19937& random);
+    [[nodiscard]] wire_list stars(int segments, int gridSize, std::mt19937& random);
+    [[nodiscard]] wire_list manhattan(int segments, int gridSize, std::mt19937& random);
+    [[nodiscard]] QVector<layout> layouts();
+    [[nodiscard]] int segments_count(const wire_list& wires);
+}
@@ -0,0 +1,230 @@
+#include "layouts.h"
+#include "../../manager.h"
+#include "../../wire.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVector2D>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <numeric>
+#include <string>
+
+namespace
+{
+    struct options
+    {
+        QVector<int> sizes = { 1000, 10000, 100000 };
+        QVector<QString> layouts;                   // All layouts if empty
+        unsigned seed = 1;
+        int operations = 1000;                      // The number of wires used for the per-wire operations
+        int gridSize = 20;
+        QString output;                             // Print to stdout if empty
+    };
+
+    void print_usage(const char* name)
+    {
+        std::printf(
+            "Usage: %s [options]\n"
+            "  --sizes <n,...>       Number of segments of the layouts, up to 1000000 (default: 1000,10000,100000)\n"
+            "  --layouts <name,...>  Layouts to run: grid, buses, stars, manhattan (default: all)\n"
+            "  --seed <n>            Seed of the random number generator (default: 1)\n"
+            "  --operations <n>      Number of wires used for the per-wire operations (default: 1000)\n"
+            "  --output <file>       Write the JSON results to a file instead of stdout\n",
+            name
+        );
+    }
+
+    QVector<std::string> split(const std::string& string)
+    {
+        QVector<std::string> parts;
+        std::size_t start = 0;
+        while (start <= string.size()) {
+            const std::size_t end = std::min(string.find(',', start), string.size());
+            if (end > start) {
+                parts.append(string.substr(start, end - start));
+            }
+            start = end + 1;
+        }
+        return parts;
+    }
+
+    bool parse(int argc, char* argv[], options& options)
+    {
+        for (int i = 1; i < argc; i++) {
+            const char* argument = argv[i];
+            if (std::strcmp(argument, "--help") == 0) {
+                return false;
+            }
+
+            // All the other options have a value
+            if (i + 1 >= argc) {
+                return false;
+            }
+            const std::string value = argv[++i];
+
+            try {
+                if (std::strcmp(argument, "--sizes") == 0) {
+                    options.sizes.clear();
+                    for (const auto& size : split(value)) {
+                        options.sizes.append(std::stoi(size));
+                    }
+                } else if (std::strcmp(argument, "--layouts") == 0) {
+                    for (const auto& layout : split(value)) {
+                        options.layouts.append(QString::fromStdString(layout));
+                    }
+                } else if (std::strcmp(argument, "--seed") == 0) {
+                    options.seed = static_cast<unsigned>(std::stoul(value));
+                } else if (std::strcmp(argument, "--operations") == 0) {
+                    options.operations = std::stoi(value);
+                } else if (std::strcmp(argument, "--output") == 0) {
+                    options.output = QString::fromStdString(value);
+                } else {
+                    return false;
+                }
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Runs the function once and returns the timing of the operations it did
+     */
+    template<typename Function>
+    QJsonObject measure(int count, Function&& function)
+    {
+        const auto start = std::chrono::steady_clock::now();
+        function();
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+
+        QJsonObject result;
+        result.insert("count", count);
+        result.insert("total_ms", elapsed.count());
+        result.insert("per_operation_us", count > 0 ? elapsed.count() * 1000 / count : 0.0);
+        return result;
+    }
+
+    QJsonObject run(const bench::layout& layout, int size, const options& options)
+    {
+        std::mt19937 random(options.seed);
+        const bench::wire_list wires = layout.generate(size, options.gridSize, random);
+        const int segments = bench::segments_count(wires);
+
+        // The wires the per-wire operations are applied to
+        QVector<int> indices(wires.count());
+        std::iota(indices.begin(), indices.end(), 0);
+        std::shuffle(indices.begin(), indices.end(), random);
+        bench::wire_list sample;
+        for (int i = 0; i < std::min(options.operations, static_cast<int>(indices.count())); i++) {
+            sample.append(wires.at(indices.at(i)));
+        }
+
+        wire_system::manager manager;
+        Settings settings;
+        settings.gridSize = options.gridSize;
+        manager.set_settings(settings);
+
+        QJsonObject operations;
+        operations.insert("add_wire", measure(wires.count(), [&] {
+            for (const auto& wire : wires) {
+                manager.add_wire(wire);
+            }
+        }));
+        operations.insert("generate_junctions", measure(1, [&] {
+            manager.generate_junctions();
+        }));
+        operations.insert("wires_connected_to", measure(sample.count(), [&] {
+            for (const auto& wire : sample) {
+                const auto connected = manager.wires_connected_to(wire);
+                Q_UNUSED(connected)
+            }
+        }));
+        operations.insert("point_moved_by_user", measure(sample.count() * 2, [&] {
+            // Move the last point away and back
+            const QVector2D moveBy(0, options.gridSize);
+            for (const auto& wire : sample) {
+                const int index = wire->points_count() - 1;
+                wire->move_point_by(index, moveBy);
+                manager.point_moved_by_user(*wire, index);
+                wire->move_point_by(index, -moveBy);
+                manager.point_moved_by_user(*wire, index);
+            }
+        }));
+        operations.insert("simplify", measure(wires.count(), [&] {
+            for (const auto& wire : wires) {
+                wire->simplify();
+            }
+        }));
+        operations.insert("remove_wire", measure(sample.count(), [&] {
+            for (const auto& wire : sample) {
+                manager.remove_wire(wire);
+            }
+        }));
+
+        QJsonObject result;
+        result.insert("layout", layout.name);
+        result.insert("size", size);
+        result.insert("segments", segments);
+        result.insert("wires", wires.count());
+        result.insert("operations", operations);
+        return result;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    options options;
+    if (!parse(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    // Select the layouts
+    QVector<bench::layout> layouts;
+    for (const auto& layout : bench::layouts()) {
+        if (options.layouts.isEmpty() || options.layouts.contains(layout.name)) {
+            layouts.append(layout);
+        }
+    }
+    if (layouts.isEmpty()) {
+        std::fprintf(stderr, "No matching layout\n");
+        return 1;
+    }
+
+    QJsonArray results;
+    for (const auto& layout : layouts) {
+        for (int size : options.sizes) {
+            std::fprintf(stderr, "%s: %d segments\n", layout.name.toStdString().c_str(), size);
+            results.append(run(layout, size, options));
+        }
+    }
+
+    QJsonObject object;
+    object.insert("seed", static_cast<qint64>(options.seed));
+    object.insert("grid_size", options.gridSize);
+    object.insert("operations", options.operations);
+    object.insert("results", results);
+    const QByteArray json = QJsonDocument(object).toJson();
+
+    if (options.output.isEmpty()) {
+        std::fputs(json.constData(), stdout);
+        return 0;
+    }
+
+    QFile file(options.output);
+    if (!file.open(QIODevice::WriteOnly)) {
+        std::fprintf(stderr, "Could not open %s\n", options.output.toStdString().c_str());
+        return 1;
+    }
+    file.write(json);
+
+    return 0;
+}
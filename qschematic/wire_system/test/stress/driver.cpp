@@ -0,0 +1,223 @@
+#include "driver.h"
+#include "../../manager.h"
+#include "../../wire.h"
+
+#include <QVector2D>
+
+#include <chrono>
+
+using namespace stress;
+
+driver::driver(wire_system::manager& manager, unsigned seed, int area) :
+    m_manager(manager),
+    m_random(seed),
+    m_area(area),
+    m_steps(0)
+{
+}
+
+/**
+ * Applies a random operation and records how long it took
+ */
+driver::operation driver::step()
+{
+    const operation operation = pick_operation();
+
+    const auto start = std::chrono::steady_clock::now();
+    apply(operation);
+    const double elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+
+    timing& timing = m_timings[operation];
+    timing.count++;
+    timing.total_ms += elapsed;
+    if (elapsed > timing.max_ms) {
+        timing.max_ms = elapsed;
+        timing.slowest_step = m_steps;
+    }
+    m_steps++;
+
+    return operation;
+}
+
+int driver::steps() const
+{
+    return m_steps;
+}
+
+const driver::timing& driver::timing_of(operation operation) const
+{
+    return m_timings[operation];
+}
+
+QVector<const wire_system::connectable*> driver::connectors() const
+{
+    QVector<const wire_system::connectable*> connectors;
+    connectors.reserve(static_cast<int>(m_connectors.size()));
+    for (const auto& connector : m_connectors) {
+        connectors.append(connector.get());
+    }
+    return connectors;
+}
+
+const char* driver::name(operation operation)
+{
+    switch (operation) {
+    case add_wire:          return "add_wire";
+    case move_point:        return "move_point";
+    case insert_point:      return "insert_point";
+    case remove_point:      return "remove_point";
+    case remove_wire:       return "remove_wire";
+    case attach_connector:  return "attach_connector";
+    case move_connector:    return "move_connector";
+    case detach_connector:  return "detach_connector";
+    case operations_count:  break;
+    }
+    return "";
+}
+
+driver::operation driver::pick_operation()
+{
+    // Relative weights of the operations
+    static const int weights[operations_count] = { 25, 25, 10, 10, 10, 8, 8, 4 };
+
+    if (m_wires.isEmpty()) {
+        return add_wire;
+    }
+
+    std::discrete_distribution<int> distribution(std::begin(weights), std::end(weights));
+    return static_cast<operation>(distribution(m_random));
+}
+
+QPointF driver::random_point()
+{
+    std::uniform_int_distribution<int> cell(0, m_area);
+    const int gridSize = m_manager.settings().gridSize;
+    const int x = cell(m_random);
+    const int y = cell(m_random);
+    return QPointF(x * gridSize, y * gridSize);
+}
+
+QVector2D driver::random_move()
+{
+    std::uniform_int_distribution<int> cells(-2, 2);
+    std::bernoulli_distribution horizontal;
+    const int gridSize = m_manager.settings().gridSize;
+    const int distance = cells(m_random) * gridSize;
+    return horizontal(m_random) ? QVector2D(distance, 0) : QVector2D(0, distance);
+}
+
+int driver::random_index(int count)
+{
+    return std::uniform_int_distribution<int>(0, count - 1)(m_random);
+}
+
+void driver::apply(operation operation)
+{
+    switch (operation) {
+    case add_wire:
+    {
+        // A Manhattan wire with one to three segments
+        auto wire = std::make_shared<wire_system::wire>();
+        QPointF point = random_point();
+        wire->append_point(point);
+        std::bernoulli_distribution coin;
+        bool horizontal = coin(m_random);
+        const int segments = std::uniform_int_distribution<int>(1, 3)(m_random);
+        for (int i = 0; i < segments; i++) {
+            const QPointF target = random_point();
+            point = horizontal ? QPointF(target.x(), point.y()) : QPointF(point.x(), target.y());
+            wire->append_point(point);
+            horizontal = !horizontal;
+        }
+        m_manager.add_wire(wire);
+        m_wires.append(wire);
+
+        // Connect the ends like the scene does when a wire is drawn
+        m_manager.point_moved_by_user(*wire, 0);
+        m_manager.point_moved_by_user(*wire, wire->points_count() - 1);
+        break;
+    }
+
+    case move_point:
+    {
+        auto& wire = m_wires.at(random_index(m_wires.count()));
+        const QVector<wire_system::point> before = wire->points();
+        wire->move_point_by(random_index(wire->points_count()), random_move());
+
+        // Report every point that moved like the scene does. Preserving the straight angles
+        // also moves the neighbours and can insert points.
+        for (int index = 0; index < wire->points_count(); index++) {
+            if (before.count() != wire->points_count() || !(before.at(index) == wire->points().at(index).toPointF())) {
+                m_manager.point_moved_by_user(*wire, index);
+            }
+        }
+        break;
+    }
+
+    case insert_point:
+    {
+        // Split a segment in the middle
+        auto& wire = m_wires.at(random_index(m_wires.count()));
+        if (wire->points_count() < 2) {
+            break;
+        }
+        const int index = 1 + random_index(wire->points_count() - 1);
+        wire->insert_point(index, wire->segment(index - 1).toLineF().center());
+        break;
+    }
+
+    case remove_point:
+    {
+        // Remove a point that isn't an end
+        auto& wire = m_wires.at(random_index(m_wires.count()));
+        if (wire->points_count() < 3) {
+            break;
+        }
+        wire->remove_point(1 + random_index(wire->points_count() - 2));
+        break;
+    }
+
+    case remove_wire:
+    {
+        const int index = random_index(m_wires.count());
+        m_manager.remove_wire(m_wires.at(index));
+        m_wires.removeAt(index);
+        break;
+    }
+
+    case attach_connector:
+    {
+        // Attach a new connector to the end of a wire
+        auto& wire = m_wires.at(random_index(m_wires.count()));
+        const int index = std::bernoulli_distribution()(m_random) ? 0 : wire->points_count() - 1;
+        auto newConnector = std::make_unique<connector>();
+        newConnector->pos = wire->points().at(index).toPointF();
+        m_manager.attach_wire_to_connector(wire.get(), index, newConnector.get());
+        m_connectors.push_back(std::move(newConnector));
+        break;
+    }
+
+    case move_connector:
+    {
+        if (m_connectors.empty()) {
+            break;
+        }
+        auto& movedConnector = m_connectors.at(random_index(static_cast<int>(m_connectors.size())));
+        movedConnector->pos += random_move().toPointF();
+        m_manager.connector_moved(movedConnector.get());
+        break;
+    }
+
+    case detach_connector:
+    {
+        if (m_connectors.empty()) {
+            break;
+        }
+        m_manager.detach_wire(m_connectors.at(random_index(static_cast<int>(m_connectors.size()))).get());
+        break;
+    }
+
+    case operations_count:
+        break;
+    }
+}
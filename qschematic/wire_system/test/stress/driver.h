@@ -0,0 +1,76 @@
+#pragma once
+
+#include "../connector.h"
+
+#include <QVector>
+#include <QVector2D>
+
+#include <memory>
+#include <random>
+#include <vector>
+
+namespace wire_system
+{
+    class manager;
+    class wire;
+}
+
+namespace stress
+{
+    /**
+     * Applies random operations to a manager the same way the scene does. The same
+     * seed always produces the same sequence of operations.
+     */
+    class driver
+    {
+    public:
+        enum operation {
+            add_wire,
+            move_point,
+            insert_point,
+            remove_point,
+            remove_wire,
+            attach_connector,
+            move_connector,
+            detach_connector,
+            operations_count
+        };
+
+        struct timing
+        {
+            int count = 0;
+            double total_ms = 0;
+            double max_ms = 0;
+            int slowest_step = -1;
+        };
+
+        driver(wire_system::manager& manager, unsigned seed, int area);
+        driver(const driver& other) = delete;
+        driver(driver&& other) = delete;
+        ~driver() = default;
+
+        driver& operator=(const driver& rhs) = delete;
+        driver& operator=(driver&& rhs) = delete;
+
+        operation step();
+        [[nodiscard]] int steps() const;
+        [[nodiscard]] const timing& timing_of(operation operation) const;
+        [[nodiscard]] QVector<const wire_system::connectable*> connectors() const;
+        [[nodiscard]] static const char* name(operation operation);
+
+    private:
+        [[nodiscard]] operation pick_operation();
+        [[nodiscard]] QPointF random_point();
+        [[nodiscard]] QVector2D random_move();
+        [[nodiscard]] int random_index(int count);
+        void apply(operation operation);
+
+        wire_system::manager& m_manager;
+        std::mt19937 m_random;
+        int m_area;                                                 // The size of the area the wires are in, in grid cells
+        int m_steps;
+        QVector<std::shared_ptr<wire_system::wire>> m_wires;
+        std::vector<std::unique_ptr<connector>> m_connectors;
+        timing m_timings[operations_count];
+    };
+}
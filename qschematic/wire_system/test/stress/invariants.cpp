@@ -0,0 +1,143 @@
+#include "invariants.h"
+#include "../../manager.h"
+#include "../../net.h"
+#include "../../wire.h"
+
+#include <QHash>
+#include <QSet>
+
+using namespace stress;
+
+namespace
+{
+    QString describe(const QHash<const wire_system::wire*, int>& ids, const wire_system::wire* wire)
+    {
+        return QString("wire ") + QString::number(ids.value(wire, -1));
+    }
+}
+
+QStringList stress::check_invariants(const wire_system::manager& manager, const QVector<const wire_system::connectable*>& connectors, bool geometry)
+{
+    QStringList violations;
+
+    // Net membership: every wire is in exactly one net and knows about it
+    QHash<const wire_system::wire*, int> ids;
+    for (const auto& net : manager.nets()) {
+        if (!net) {
+            violations << QString("null net");
+            continue;
+        }
+        if (net->wires_count() < 1) {
+            violations << QString("empty net");
+        }
+        for (const auto* wire : net->raw_wires()) {
+            if (ids.contains(wire)) {
+                violations << describe(ids, wire) + " is in more than one net";
+                continue;
+            }
+            ids.insert(wire, ids.count());
+            if (wire->net().get() != net.get()) {
+                violations << describe(ids, wire) + " doesn't point to its net";
+            }
+        }
+    }
+
+    // Connections: connected wires are managed and in the same net
+    QHash<const wire_system::wire*, QVector<const wire_system::wire*>> connectedTo;
+    for (auto it = ids.constBegin(); it != ids.constEnd(); ++it) {
+        const auto* wire = it.key();
+        for (const auto* otherWire : wire->connected_wires()) {
+            if (!ids.contains(otherWire)) {
+                violations << describe(ids, wire) + " is connected to a wire that isn't managed";
+                continue;
+            }
+            if (otherWire->net().get() != wire->net().get()) {
+                violations << describe(ids, wire) + " and " + describe(ids, otherWire) + " are connected but in different nets";
+            }
+            if (!manager.are_connected(wire, otherWire)) {
+                violations << describe(ids, wire) + " and " + describe(ids, otherWire) + " are connected but not in the connectivity";
+            }
+            connectedTo[otherWire].append(wire);
+        }
+    }
+
+    // Junction flags: only the ends of a wire can be junctions and they need a wire to be connected to
+    for (auto it = ids.constBegin(); it != ids.constEnd(); ++it) {
+        const auto* wire = it.key();
+        const auto& points = wire->points();
+        const auto& targets = connectedTo.value(wire);
+        bool hasJunction = false;
+        for (int index = 0; index < points.count(); index++) {
+            if (!points.at(index).is_junction()) {
+                continue;
+            }
+            hasJunction = true;
+            if (index != 0 && index != points.count() - 1) {
+                violations << describe(ids, wire) + " has a junction on point " + QString::number(index) + " which isn't an end";
+            }
+        }
+        if (hasJunction && targets.isEmpty()) {
+            violations << describe(ids, wire) + " has a junction but isn't connected to any wire";
+        }
+        if (!hasJunction && !targets.isEmpty()) {
+            violations << describe(ids, wire) + " is connected to " + describe(ids, targets.first()) + " without a junction";
+        }
+
+        // The junctions are on the wires they are connected to
+        if (!geometry) {
+            continue;
+        }
+        for (int index : wire->junctions()) {
+            bool onTarget = false;
+            for (const auto* target : targets) {
+                if (target->point_is_on_wire(points.at(index).toPointF())) {
+                    onTarget = true;
+                    break;
+                }
+            }
+            if (!onTarget) {
+                violations << describe(ids, wire) + " has a junction on point " + QString::number(index) + " that isn't on a connected wire";
+            }
+        }
+        for (const auto* target : targets) {
+            bool onTarget = false;
+            for (int index : wire->junctions()) {
+                if (target->point_is_on_wire(points.at(index).toPointF())) {
+                    onTarget = true;
+                    break;
+                }
+            }
+            if (!onTarget) {
+                violations << describe(ids, wire) + " is connected to " + describe(ids, target) + " without a junction on it";
+            }
+        }
+    }
+
+    // Attachments: both indices agree and point to an existing point
+    for (const auto* connector : connectors) {
+        const auto* wire = manager.attached_wire(connector);
+        if (!wire) {
+            continue;
+        }
+        if (!ids.contains(wire)) {
+            violations << QString("a connector is attached to a wire that isn't managed");
+            continue;
+        }
+        const int index = manager.attached_point(connector);
+        if (index < 0 || index >= wire->points_count()) {
+            violations << QString("a connector is attached to point ") + QString::number(index) + " of " + describe(ids, wire) + " which doesn't exist";
+        }
+        if (!manager.attached_connectors(wire).contains(connector)) {
+            violations << describe(ids, wire) + " doesn't know about a connector attached to it";
+        }
+    }
+    for (auto it = ids.constBegin(); it != ids.constEnd(); ++it) {
+        for (const auto* connector : manager.attached_connectors(it.key())) {
+            if (manager.attached_wire(connector) != it.key()) {
+                violations << describe(ids, it.key()) + " has a connector that is attached to another wire";
+            }
+        }
+    }
+
+    return violations;
+}
@@ -0,0 +1,21 @@
+#pragma once
+
+#include <QStringList>
+#include <QVector>
+
+namespace wire_system
+{
+    class manager;
+    class connectable;
+}
+
+namespace stress
+{
+    /**
+     * Checks the structural invariants of the manager: net membership, the junction
+     * flags and the connector attachments. Runs in linear time.
+     * \param geometry Whether to also check that the junctions are on the wires they are connected to
+     * \return A description of every violation that was found
+     */
+    [[nodiscard]] QStringList check_invariants(const wire_system::manager& manager, const QVector<const wire_system::connectable*>& connectors, bool geometry = true);
+}
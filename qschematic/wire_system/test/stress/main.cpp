@@ -0,0 +1,165 @@
+#include "driver.h"
+#include "invariants.h"
+#include "../../manager.h"
+
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <string>
+
+namespace
+{
+    struct options
+    {
+        unsigned seed = 1;
+        int steps = 100000;
+        int checkEvery = 1000;      // The number of operations between two checks of the invariants
+        int area = 100;             // The size of the area the wires are in, in grid cells
+        bool geometry = true;
+        QString output;             // Print to stdout if empty
+    };
+
+    void print_usage(const char* name)
+    {
+        std::printf(
+            "Usage: %s [options]\n"
+            "  --seed <n>         Seed of the random operations (default: 1)\n"
+            "  --steps <n>        Number of operations to apply (default: 100000)\n"
+            "  --check-every <n>  Number of operations between two checks of the invariants (default: 1000)\n"
+            "  --area <n>         Size of the area the wires are in, in grid cells (default: 100)\n"
+            "  --no-geometry      Don't check that the junctions are on the wires they are connected to\n"
+            "  --output <file>    Write the JSON results to a file instead of stdout\n",
+            name
+        );
+    }
+
+    bool parse(int argc, char* argv[], options& options)
+    {
+        for (int i = 1; i < argc; i++) {
+            const char* argument = argv[i];
+            if (std::strcmp(argument, "--no-geometry") == 0) {
+                options.geometry = false;
+                continue;
+            }
+
+            // All the other options have a value
+            if (i + 1 >= argc) {
+                return false;
+            }
+            const std::string value = argv[++i];
+
+            try {
+                if (std::strcmp(argument, "--seed") == 0) {
+                    options.seed = static_cast<unsigned>(std::stoul(value));
+                } else if (std::strcmp(argument, "--steps") == 0) {
+                    options.steps = std::stoi(value);
+                } else if (std::strcmp(argument, "--check-every") == 0) {
+                    options.checkEvery = std::max(1, std::stoi(value));
+                } else if (std::strcmp(argument, "--area") == 0) {
+                    options.area = std::max(1, std::stoi(value));
+                } else if (std::strcmp(argument, "--output") == 0) {
+                    options.output = QString::fromStdString(value);
+                } else {
+                    return false;
+                }
+            } catch (const std::exception&) {
+                return false;
+            }
+        }
+
+        return true;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    options options;
+    if (!parse(argc, argv, options)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+
+    wire_system::manager manager;
+    stress::driver driver(manager, options.seed, options.area);
+
+    QJsonArray batches;
+    QJsonArray violations;
+    double checksMs = 0;
+    int checks = 0;
+    auto batchStart = std::chrono::steady_clock::now();
+    while (driver.steps() < options.steps && violations.count() == 0) {
+        driver.step();
+        if (driver.steps() % options.checkEvery != 0 && driver.steps() < options.steps) {
+            continue;
+        }
+        const double batchMs = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - batchStart).count();
+
+        // Check the invariants
+        const auto checkStart = std::chrono::steady_clock::now();
+        const QStringList found = stress::check_invariants(manager, driver.connectors(), options.geometry);
+        checksMs += std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - checkStart).count();
+        checks++;
+        for (const auto& violation : found) {
+            violations.append(violation);
+        }
+
+        QJsonObject batch;
+        batch.insert("step", driver.steps());
+        batch.insert("wires", manager.wires().count());
+        batch.insert("nets", manager.nets().count());
+        batch.insert("total_ms", batchMs);
+        batches.append(batch);
+
+        if (!found.isEmpty()) {
+            std::fprintf(stderr, "Seed %u: %d violations after step %d, the first one is: %s\n",
+                         options.seed, static_cast<int>(found.count()), driver.steps(), found.first().toStdString().c_str());
+        }
+        batchStart = std::chrono::steady_clock::now();
+    }
+
+    QJsonObject operations;
+    for (int i = 0; i < stress::driver::operations_count; i++) {
+        const auto operation = static_cast<stress::driver::operation>(i);
+        const auto& timing = driver.timing_of(operation);
+        QJsonObject object;
+        object.insert("count", timing.count);
+        object.insert("total_ms", timing.total_ms);
+        object.insert("mean_us", timing.count > 0 ? timing.total_ms * 1000 / timing.count : 0.0);
+        object.insert("max_ms", timing.max_ms);
+        object.insert("slowest_step", timing.slowest_step);
+        operations.insert(stress::driver::name(operation), object);
+    }
+
+    QJsonObject checksObject;
+    checksObject.insert("count", checks);
+    checksObject.insert("total_ms", checksMs);
+
+    QJsonObject object;
+    object.insert("seed", static_cast<qint64>(options.seed));
+    object.insert("steps", driver.steps());
+    object.insert("area", options.area);
+    object.insert("operations", operations);
+    object.insert("checks", checksObject);
+    object.insert("batches", batches);
+    object.insert("violations", violations);
+    const QByteArray json = QJsonDocument(object).toJson();
+
+    if (options.output.isEmpty()) {
+        std::fputs(json.constData(), stdout);
+    } else {
+        QFile file(options.output);
+        if (!file.open(QIODevice::WriteOnly)) {
+            std::fprintf(stderr, "Could not open %s\n", options.output.toStdString().c_str());
+            return 1;
+        }
+        file.write(json);
+    }
+
+    return violations.isEmpty() ? 0 : 2;
+}
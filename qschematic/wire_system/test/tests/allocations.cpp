@@ -0,0 +1,58 @@
+#include "../3rdparty/doctest.h"
+#include "../allocation_counter.h"
+#include "../../manager.h"
+#include "../../wire.h"
+
+#include <QVector2D>
+
+TEST_SUITE("Allocations")
+{
+    TEST_CASE("Dragging a point doesn't allocate")
+    {
+        wire_system::manager manager;
+        Settings settings;
+        settings.gridSize = 1;
+        settings.preserveStraightAngles = true;
+        manager.set_settings(settings);
+
+        // An L-shaped wire
+        auto wire = std::make_shared<wire_system::wire>();
+        wire->append_point({0, 0});
+        wire->append_point({100, 0});
+        wire->append_point({100, 100});
+        manager.add_wire(wire);
+
+        // A wire that ends on the horizontal segment
+        auto otherWire = std::make_shared<wire_system::wire>();
+        otherWire->append_point({50, 50});
+        otherWire->append_point({50, 0});
+        manager.add_wire(otherWire);
+        manager.generate_junctions();
+        REQUIRE(wire->connected_wires().contains(otherWire.get()));
+
+        // Drag the corner and the end point back and forth
+        auto drag = [&](int index, const QVector2D& moveBy) {
+            wire->move_point_by(index, moveBy);
+            manager.point_moved_by_user(*wire, index);
+        };
+        auto dragAround = [&]() {
+            drag(1, QVector2D(0, 10));
+            drag(1, QVector2D(0, -10));
+            drag(2, QVector2D(10, 0));
+            drag(2, QVector2D(-10, 0));
+        };
+
+        // Warm up
+        for (int i = 0; i < 3; i++) {
+            dragAround();
+        }
+
+        allocations::start_counting();
+        for (int i = 0; i < 100; i++) {
+            dragAround();
+        }
+        REQUIRE(allocations::stop_counting() == 0);
+        REQUIRE(wire->points_count() == 3);
+        REQUIRE(otherWire->points().last().toPointF() == QPointF(50, 0));
+    }
+}
@@ -0,0 +1,184 @@
+#include "../3rdparty/doctest.h"
+#include "../connector.h"
+#include "../../manager.h"
+#include "../../net.h"
+#include "../../wire.h"
+
+#include <chrono>
+
+namespace
+{
+    std::shared_ptr<wire_system::wire> create_wire(const QPointF& p1, const QPointF& p2)
+    {
+        auto wire = std::make_shared<wire_system::wire>();
+        wire->append_point(p1);
+        wire->append_point(p2);
+        return wire;
+    }
+
+    /**
+     * Creates horizontal buses with vertical wires ending on them
+     */
+    QVector<std::shared_ptr<wire_system::wire>> add_buses(wire_system::manager& manager, int buses, int wiresPerBus)
+    {
+        QVector<std::shared_ptr<wire_system::wire>> wires;
+        for (int b = 0; b < buses; b++) {
+            const qreal y = b * 100;
+            auto bus = create_wire({0, y}, {wiresPerBus * 20.0, y});
+            manager.add_wire(bus);
+            wires.append(bus);
+            for (int w = 0; w < wiresPerBus; w++) {
+                auto wire = create_wire({w * 20.0 + 10, y + 50}, {w * 20.0 + 10, y});
+                manager.add_wire(wire);
+                wires.append(wire);
+            }
+        }
+        return wires;
+    }
+}
+
+TEST_SUITE("Batch")
+{
+    TEST_CASE("Junctions are generated when the batch is committed")
+    {
+        wire_system::manager manager;
+
+        manager.begin_batch();
+        REQUIRE(manager.in_batch());
+        const auto wires = add_buses(manager, 2, 5);
+
+        // Nothing is connected yet
+        REQUIRE(manager.nets().count() == 12);
+        REQUIRE_FALSE(wires[1]->points().last().is_junction());
+
+        // Nested batches are only resolved by the outermost commit
+        manager.begin_batch();
+        manager.commit();
+        REQUIRE(manager.nets().count() == 12);
+
+        manager.commit();
+        REQUIRE_FALSE(manager.in_batch());
+        REQUIRE(manager.nets().count() == 2);
+        REQUIRE(wires[1]->points().last().is_junction());
+        REQUIRE(manager.are_connected(wires[1].get(), wires[5].get()));
+        REQUIRE_FALSE(manager.are_connected(wires[1].get(), wires[7].get()));
+    }
+
+    TEST_CASE("Only the wires added during the batch are connected")
+    {
+        wire_system::manager manager;
+
+        // Two wires that touch but aren't connected
+        auto bus = create_wire({0, 0}, {100, 0});
+        auto wire1 = create_wire({20, 50}, {20, 0});
+        manager.add_wire(bus);
+        manager.add_wire(wire1);
+
+        manager.begin_batch();
+        auto wire2 = create_wire({40, 50}, {40, 0});
+        manager.add_wire(wire2);
+        manager.commit();
+
+        REQUIRE(bus->connected_wires().contains(wire2.get()));
+        REQUIRE_FALSE(bus->connected_wires().contains(wire1.get()));
+    }
+
+    TEST_CASE("Existing wires that end on the added wires are connected")
+    {
+        wire_system::manager manager;
+
+        // A wire that ends where the bus is going to be and one far away
+        auto wire1 = create_wire({20, 50}, {20, 0});
+        auto wire2 = create_wire({1020, 50}, {1020, 0});
+        manager.add_wire(wire1);
+        manager.add_wire(wire2);
+
+        manager.begin_batch();
+        auto bus = create_wire({0, 0}, {100, 0});
+        manager.add_wire(bus);
+        manager.commit();
+
+        REQUIRE(bus->connected_wires().contains(wire1.get()));
+        REQUIRE(wire1->points().last().is_junction());
+        REQUIRE(wire1->net().get() == bus->net().get());
+        REQUIRE_FALSE(wire2->points().last().is_junction());
+        REQUIRE(manager.nets().count() == 2);
+    }
+
+    TEST_CASE("Points moved by the user are processed when the batch is committed")
+    {
+        wire_system::manager manager;
+
+        auto bus = create_wire({0, 0}, {100, 0});
+        auto wire = create_wire({40, 50}, {40, 20});
+        manager.add_wire(bus);
+        manager.add_wire(wire);
+
+        manager.begin_batch();
+        wire->move_point_to(1, {40, 10});
+        manager.point_moved_by_user(*wire, 1);
+        wire->move_point_to(1, {40, 0});
+        manager.point_moved_by_user(*wire, 1);
+        REQUIRE_FALSE(bus->connected_wires().contains(wire.get()));
+
+        SUBCASE("Committing")
+        {
+            manager.commit();
+            REQUIRE(bus->connected_wires().contains(wire.get()));
+            REQUIRE(wire->points().last().is_junction());
+            REQUIRE(bus->net().get() == wire->net().get());
+        }
+
+        SUBCASE("Removing the wire before committing")
+        {
+            manager.remove_wire(wire);
+            manager.commit();
+            REQUIRE(bus->connected_wires().isEmpty());
+        }
+    }
+
+    TEST_CASE("Wires follow the connectors when the batch is committed")
+    {
+        wire_system::manager manager;
+        Settings settings;
+        settings.gridSize = 1;
+        settings.preserveStraightAngles = false;
+        manager.set_settings(settings);
+
+        auto wire = create_wire({0, 10}, {10, 10});
+        manager.add_wire(wire);
+        connector conn;
+        conn.pos = QPointF(10, 10);
+        manager.attach_wire_to_connector(wire.get(), &conn);
+
+        manager.begin_batch();
+        conn.pos = QPointF(10, 20);
+        manager.connector_moved(&conn);
+        conn.pos = QPointF(10, 30);
+        manager.connector_moved(&conn);
+        REQUIRE(wire->points().last().toPointF() == QPointF(10, 10));
+
+        manager.commit();
+        REQUIRE(wire->points().last().toPointF() == QPointF(10, 30));
+    }
+
+    TEST_CASE("Benchmark: Building a design in a batch")
+    {
+        const int counts[2] = { 10, 100 };
+        double times[2];
+
+        for (int i = 0; i < 2; i++) {
+            wire_system::manager manager;
+
+            const auto start = std::chrono::steady_clock::now();
+            manager.begin_batch();
+            const auto wires = add_buses(manager, counts[i], 100);
+            manager.commit();
+            const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+            times[i] = elapsed.count();
+
+            REQUIRE(manager.nets().count() == counts[i]);
+            MESSAGE(wires.count() << " wires: " << times[i] << " ms");
+        }
+    }
+}
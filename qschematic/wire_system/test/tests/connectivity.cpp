@@ -0,0 +1,234 @@
+#include "../3rdparty/doctest.h"
+#include "../../connectivity.h"
+#include "../../manager.h"
+#include "../../net.h"
+#include "../../wire.h"
+
+#include <chrono>
+#include <random>
+#include <set>
+
+TEST_SUITE("Connectivity")
+{
+    TEST_CASE("Sets follow the connections")
+    {
+        wire_system::wire wires[5];
+        wire_system::connectivity connectivity;
+        for (auto& wire : wires) {
+            connectivity.insert(&wire);
+        }
+
+        REQUIRE(connectivity.components_count() == 5);
+        REQUIRE_FALSE(connectivity.connected(&wires[0], &wires[1]));
+
+        // Connect
+        REQUIRE(connectivity.connect(&wires[0], &wires[1]));
+        REQUIRE(connectivity.connect(&wires[2], &wires[1]));
+        REQUIRE(connectivity.connect(&wires[2], &wires[3]));
+        REQUIRE_FALSE(connectivity.connect(&wires[0], &wires[1]));
+        REQUIRE(connectivity.components_count() == 2);
+        REQUIRE(connectivity.connected(&wires[0], &wires[3]));
+        REQUIRE_FALSE(connectivity.connected(&wires[0], &wires[4]));
+        REQUIRE(connectivity.component(&wires[3]).count() == 4);
+        REQUIRE(connectivity.connected_by(&wires[1]).count() == 2);
+
+        SUBCASE("Disconnecting splits off the smaller part")
+        {
+            REQUIRE(connectivity.connect(&wires[3], &wires[4]));
+            const auto part = connectivity.disconnect(&wires[2], &wires[1]);
+            REQUIRE(part.count() == 2);
+            REQUIRE(part.contains(&wires[0]));
+            REQUIRE(part.contains(&wires[1]));
+            REQUIRE(connectivity.components_count() == 2);
+            REQUIRE(connectivity.connected(&wires[0], &wires[1]));
+            REQUIRE(connectivity.connected(&wires[2], &wires[4]));
+            REQUIRE_FALSE(connectivity.connected(&wires[1], &wires[2]));
+        }
+
+        SUBCASE("Connections in both directions")
+        {
+            REQUIRE(connectivity.connect(&wires[1], &wires[0]));
+            REQUIRE(connectivity.disconnect(&wires[0], &wires[1]).isEmpty());
+            REQUIRE(connectivity.connected(&wires[0], &wires[1]));
+        }
+
+        SUBCASE("Removing a wire")
+        {
+            const auto parts = connectivity.remove(&wires[1]);
+            REQUIRE(parts.count() == 1);
+            REQUIRE_FALSE(connectivity.contains(&wires[1]));
+            REQUIRE(connectivity.component(&wires[1]).isEmpty());
+            REQUIRE(connectivity.components_count() == 3);
+            REQUIRE_FALSE(connectivity.connected(&wires[0], &wires[2]));
+            REQUIRE(connectivity.connected(&wires[2], &wires[3]));
+        }
+    }
+
+    TEST_CASE("Sets match the connected components")
+    {
+        const int count = 40;
+        std::vector<wire_system::wire> wires(count);
+        wire_system::connectivity connectivity;
+        std::set<std::pair<int, int>> connections;
+        std::vector<bool> inserted(count, true);
+        for (auto& wire : wires) {
+            connectivity.insert(&wire);
+        }
+
+        // Find the components with a plain search
+        auto components = [&]() {
+            std::vector<int> component(count, -1);
+            for (int start = 0; start < count; start++) {
+                if (!inserted[start] || component[start] >= 0) {
+                    continue;
+                }
+                std::vector<int> stack = { start };
+                component[start] = start;
+                while (!stack.empty()) {
+                    const int current = stack.back();
+                    stack.pop_back();
+                    for (const auto& [a, b] : connections) {
+                        const int other = (a == current) ? b : (b == current) ? a : -1;
+                        if (other >= 0 && component[other] < 0) {
+                            component[other] = start;
+                            stack.push_back(other);
+                        }
+                    }
+                }
+            }
+            return component;
+        };
+
+        std::mt19937 random(42);
+        std::uniform_int_distribution<int> pick(0, count - 1);
+        std::uniform_int_distribution<int> operation(0, 9);
+        for (int i = 0; i < 2000; i++) {
+            const int a = pick(random);
+            const int b = pick(random);
+            const int op = operation(random);
+            if (op < 5) {
+                if (a != b && inserted[a] && inserted[b]) {
+                    connectivity.connect(&wires[a], &wires[b]);
+                    connections.insert({ a, b });
+                }
+            } else if (op < 9) {
+                if (!connections.empty()) {
+                    auto it = connections.begin();
+                    std::advance(it, a % connections.size());
+                    connectivity.disconnect(&wires[it->first], &wires[it->second]);
+                    connections.erase(it);
+                }
+            } else if (inserted[a]) {
+                connectivity.remove(&wires[a]);
+                inserted[a] = false;
+                for (auto it = connections.begin(); it != connections.end();) {
+                    it = (it->first == a || it->second == a) ? connections.erase(it) : std::next(it);
+                }
+            } else {
+                connectivity.insert(&wires[a]);
+                inserted[a] = true;
+            }
+
+            const auto component = components();
+            for (int x = 0; x < count; x++) {
+                REQUIRE(connectivity.contains(&wires[x]) == inserted[x]);
+                for (int y = x + 1; y < count; y++) {
+                    if (inserted[x] && inserted[y]) {
+                        REQUIRE(connectivity.connected(&wires[x], &wires[y]) == (component[x] == component[y]));
+                    }
+                }
+            }
+        }
+    }
+
+    TEST_CASE("Nets follow the connections of the wires")
+    {
+        wire_system::manager manager;
+
+        // Create a horizontal wire with three wires ending on it
+        auto bus = std::make_shared<wire_system::wire>();
+        bus->append_point({0, 0});
+        bus->append_point({100, 0});
+        manager.add_wire(bus);
+
+        QVector<std::shared_ptr<wire_system::wire>> wires;
+        for (int i = 1; i <= 3; i++) {
+            auto wire = std::make_shared<wire_system::wire>();
+            wire->append_point({i * 20.0, 50});
+            wire->append_point({i * 20.0, 0});
+            manager.add_wire(wire);
+            wires.append(wire);
+        }
+        manager.generate_junctions();
+
+        REQUIRE(manager.nets().count() == 1);
+        REQUIRE(manager.are_connected(wires[0].get(), wires[2].get()));
+        REQUIRE(manager.wires_connected_to(wires[0]).count() == 4);
+
+        SUBCASE("The name of the net is kept when merging")
+        {
+            auto wire = std::make_shared<wire_system::wire>();
+            wire->append_point({100, 0});
+            wire->append_point({100, 50});
+            manager.add_wire(wire);
+            wire->net()->set_name(QString("VCC"));
+
+            manager.connect_wire(bus.get(), wire.get(), 0);
+            REQUIRE(wire->net().get() == bus->net().get());
+            REQUIRE(bus->net()->name() == QString("VCC"));
+            REQUIRE(manager.nets().count() == 1);
+        }
+
+        SUBCASE("Removing a wire splits the net")
+        {
+            manager.remove_wire(bus);
+
+            REQUIRE(manager.nets().count() == 3);
+            REQUIRE_FALSE(manager.are_connected(wires[0].get(), wires[1].get()));
+            REQUIRE(manager.wires_connected_to(wires[0]).count() == 1);
+            REQUIRE(wires[0]->net().get() != wires[1]->net().get());
+            REQUIRE_FALSE(wires[0]->points().last().is_junction());
+        }
+
+        SUBCASE("Disconnecting a wire splits the net")
+        {
+            manager.disconnect_wire(bus, wires[1].get());
+
+            REQUIRE(manager.nets().count() == 2);
+            REQUIRE(manager.are_connected(wires[0].get(), wires[2].get()));
+            REQUIRE_FALSE(manager.are_connected(wires[0].get(), wires[1].get()));
+            REQUIRE(manager.wires_connected_to(wires[0]).count() == 3);
+            REQUIRE(manager.wires_connected_to(wires[1]).count() == 1);
+            REQUIRE(bus->net().get() != wires[1]->net().get());
+        }
+    }
+
+    TEST_CASE("Removing a wire only moves the smaller part of the net")
+    {
+        wire_system::manager manager;
+
+        // A long chain of wires
+        const int count = 5000;
+        QVector<std::shared_ptr<wire_system::wire>> wires;
+        for (int i = 0; i < count; i++) {
+            auto wire = std::make_shared<wire_system::wire>();
+            wire->append_point({i * 20.0, 0});
+            wire->append_point({i * 20.0 + 20, 0});
+            manager.add_wire(wire);
+            wires.append(wire);
+        }
+        manager.generate_junctions();
+        REQUIRE(manager.nets().count() == 1);
+
+        const auto start = std::chrono::steady_clock::now();
+        manager.remove_wire(wires[10]);
+        const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+        MESSAGE("Removing a wire from a net with " << count << " wires: " << elapsed.count() << " us");
+
+        REQUIRE(manager.nets().count() == 2);
+        REQUIRE(wires[0]->net()->wires_count() == 10);
+        REQUIRE(wires[11]->net()->wires_count() == count - 11);
+        REQUIRE(manager.wires_connected_to(wires[0]).count() == 10);
+        REQUIRE_FALSE(manager.are_connected(wires[9].get(), wires[11].get()));
+    }
+}
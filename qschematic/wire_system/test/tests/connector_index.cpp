@@ -0,0 +1,117 @@
+#include "../3rdparty/doctest.h"
+#include "../../connector_index.h"
+#include "../../manager.h"
+#include "../connector.h"
+
+#include <chrono>
+#include <vector>
+
+TEST_SUITE("Connector index")
+{
+    TEST_CASE("Connectors are found at their position")
+    {
+        wire_system::connector_index index;
+
+        connector conn1;
+        conn1.pos = QPointF(100, 20);
+        connector conn2;
+        conn2.pos = QPointF(100, 20);
+        connector conn3;
+        conn3.pos = QPointF(-40, 60);
+        index.insert(&conn1);
+        index.insert(&conn2);
+        index.insert(&conn3);
+        index.insert(&conn3);
+
+        REQUIRE(index.connectors_count() == 3);
+        REQUIRE(index.connectors_at({100, 20}).count() == 2);
+        REQUIRE(index.connectors_at({100, 20}).contains(&conn1));
+        REQUIRE(index.connectors_at({100, 20}).contains(&conn2));
+        REQUIRE(index.connectors_at({-40, 60}).count() == 1);
+        REQUIRE(index.connectors_at({-40, 60}).first() == &conn3);
+        REQUIRE(index.connectors_at({100, 40}).isEmpty());
+
+        // The positions are rounded like when they are compared to the points of the wires
+        REQUIRE(index.connectors_at({100.3, 19.6}).count() == 2);
+        REQUIRE(index.connectors_at({-39.8, 60.2}).count() == 1);
+        REQUIRE(index.connectors_at({100.6, 20}).isEmpty());
+    }
+
+    TEST_CASE("Connectors are moved and removed")
+    {
+        wire_system::connector_index index;
+
+        connector conn1;
+        conn1.pos = QPointF(0, 0);
+        connector conn2;
+        conn2.pos = QPointF(0, 0);
+        index.insert(&conn1);
+        index.insert(&conn2);
+
+        conn1.pos = QPointF(20, 40);
+        index.moved(&conn1);
+        REQUIRE(index.connectors_at({0, 0}).count() == 1);
+        REQUIRE(index.connectors_at({0, 0}).first() == &conn2);
+        REQUIRE(index.connectors_at({20, 40}).count() == 1);
+        REQUIRE(index.connectors_at({20, 40}).first() == &conn1);
+
+        // Connectors that aren't indexed are ignored
+        connector other;
+        index.moved(&other);
+        index.remove(&other);
+        REQUIRE_FALSE(index.contains(&other));
+
+        index.remove(&conn2);
+        REQUIRE_FALSE(index.contains(&conn2));
+        REQUIRE(index.connectors_at({0, 0}).isEmpty());
+        REQUIRE(index.connectors_count() == 1);
+
+        index.clear();
+        REQUIRE(index.connectors_at({20, 40}).isEmpty());
+        REQUIRE(index.connectors_count() == 0);
+    }
+
+    TEST_CASE("The manager keeps the connectors' positions up to date")
+    {
+        wire_system::manager manager;
+
+        connector conn;
+        conn.pos = QPointF(100, 100);
+        manager.add_connector(&conn);
+        REQUIRE(manager.connectors_at({100, 100}).count() == 1);
+
+        conn.pos = QPointF(200, 100);
+        manager.connector_moved(&conn);
+        REQUIRE(manager.connectors_at({100, 100}).isEmpty());
+        REQUIRE(manager.connectors_at({200, 100}).count() == 1);
+
+        manager.remove_connector(&conn);
+        REQUIRE(manager.connectors_at({200, 100}).isEmpty());
+    }
+
+    TEST_CASE("Benchmark: Looking up connectors among 100000")
+    {
+        wire_system::connector_index index;
+
+        // Pins on a grid
+        const int count = 100000;
+        std::vector<connector> connectors(count);
+        for (int i = 0; i < count; i++) {
+            connectors[i].pos = QPointF((i % 500) * 20, (i / 500) * 20);
+            index.insert(&connectors[i]);
+        }
+
+        // Look up a pin at every other grid point
+        const int lookups = 200000;
+        int found = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < lookups; i++) {
+            found += index.connectors_at(QPointF((i % 1000) * 10, ((i / 1000) % 400) * 10)).count();
+        }
+        const auto elapsed = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start);
+        const double timePerLookup = elapsed.count() / lookups;
+        REQUIRE(found == lookups / 4);
+
+        MESSAGE(count << " connectors: " << timePerLookup << " ns per lookup");
+    }
+}
@@ -0,0 +1,277 @@
+#include "../3rdparty/doctest.h"
+#include "../../crossing_index.h"
+#include "../../manager.h"
+#include "../../wire.h"
+
+#include <QVector2D>
+
+#include <chrono>
+
+namespace
+{
+    std::shared_ptr<wire_system::wire> make_wire(const QVector<QPointF>& points)
+    {
+        auto wire = std::make_shared<wire_system::wire>();
+        for (const QPointF& point : points) {
+            wire->append_point(point);
+        }
+        return wire;
+    }
+
+    /**
+     * Counts the crossings by comparing every pair of segments
+     */
+    int count_crossings(const QVector<std::shared_ptr<wire_system::wire>>& wires)
+    {
+        QVector<wire_system::line> horizontal;
+        QVector<wire_system::line> vertical;
+        for (const auto& wire : wires) {
+            for (const auto& segment : wire->segments()) {
+                if (segment.is_null()) {
+                    continue;
+                }
+                if (segment.is_horizontal()) {
+                    horizontal.append(segment);
+                } else if (segment.is_vertical()) {
+                    vertical.append(segment);
+                }
+            }
+        }
+
+        int count = 0;
+        for (const auto& h : horizontal) {
+            for (const auto& v : vertical) {
+                const qreal x = v.p1().x();
+                const qreal y = h.p1().y();
+                if (qMin(h.p1().x(), h.p2().x()) < x && x < qMax(h.p1().x(), h.p2().x()) &&
+                    qMin(v.p1().y(), v.p2().y()) < y && y < qMax(v.p1().y(), v.p2().y())) {
+                    count++;
+                }
+            }
+        }
+        return count;
+    }
+}
+
+TEST_SUITE("Crossing index")
+{
+    TEST_CASE("Wires that cross")
+    {
+        wire_system::crossing_index index;
+
+        auto horizontal = make_wire({ {0, 0}, {200, 0} });
+        auto vertical = make_wire({ {100, -100}, {100, 100} });
+        index.insert(horizontal);
+        index.insert(vertical);
+
+        REQUIRE(index.crossings_count() == 1);
+        const auto& crossings = index.crossings(horizontal.get());
+        REQUIRE(crossings.size() == 1);
+        REQUIRE(crossings.front().point == QPointF(100, 0));
+        REQUIRE(crossings.front().other == vertical.get());
+        REQUIRE(crossings.front().segment == 0);
+        REQUIRE(crossings.front().horizontal);
+
+        REQUIRE(index.crossings(vertical.get()).size() == 1);
+        REQUIRE(index.crossings(vertical.get()).front().other == horizontal.get());
+        REQUIRE_FALSE(index.crossings(vertical.get()).front().horizontal);
+    }
+
+    TEST_CASE("Wires that touch don't cross")
+    {
+        wire_system::crossing_index index;
+
+        // A T junction, a corner and two wires that run along each other
+        auto wire1 = make_wire({ {0, 0}, {200, 0} });
+        auto wire2 = make_wire({ {100, 0}, {100, 100} });
+        auto wire3 = make_wire({ {200, 0}, {200, 100} });
+        auto wire4 = make_wire({ {0, 0}, {100, 0} });
+        index.insert(wire1);
+        index.insert(wire2);
+        index.insert(wire3);
+        index.insert(wire4);
+
+        REQUIRE(index.crossings_count() == 0);
+        REQUIRE(index.crossings(wire1.get()).empty());
+    }
+
+    TEST_CASE("A wire can cross itself")
+    {
+        wire_system::crossing_index index;
+
+        auto wire = make_wire({ {0, 0}, {200, 0}, {200, 100}, {100, 100}, {100, -100} });
+        index.insert(wire);
+
+        REQUIRE(index.crossings_count() == 1);
+        REQUIRE(index.crossings(wire.get()).size() == 2);
+
+        // Finding the crossing while the other wires are up to date
+        auto other = make_wire({ {-100, 200}, {-200, 200} });
+        index.insert(other);
+        REQUIRE(index.crossings_count() == 1);
+        index.invalidate(wire.get());
+        REQUIRE(index.crossings_count() == 1);
+    }
+
+    TEST_CASE("Crossings are updated when wires change")
+    {
+        wire_system::crossing_index index;
+
+        auto horizontal = make_wire({ {0, 0}, {200, 0} });
+        auto vertical = make_wire({ {100, -100}, {100, 100} });
+        auto far = make_wire({ {1000, 1000}, {1200, 1000} });
+        index.insert(horizontal);
+        index.insert(vertical);
+        index.insert(far);
+        REQUIRE(index.crossings_count() == 1);
+        (void)index.take_changed();
+
+        // Moving the vertical wire away
+        vertical->move_point_to(0, {300, -100});
+        vertical->move_point_to(1, {300, 100});
+        index.invalidate(vertical.get());
+        REQUIRE(index.crossings_count() == 0);
+        REQUIRE(index.crossings(horizontal.get()).empty());
+
+        // The wire that didn't change needs to know
+        auto changed = index.take_changed();
+        REQUIRE(changed.size() == 1);
+        REQUIRE(changed.front() == horizontal.get());
+        REQUIRE(index.take_changed().empty());
+
+        // Moving it back
+        vertical->move_point_to(0, {150, -100});
+        vertical->move_point_to(1, {150, 100});
+        index.invalidate(vertical.get());
+        REQUIRE(index.crossings(horizontal.get()).size() == 1);
+        REQUIRE(index.crossings(horizontal.get()).front().point == QPointF(150, 0));
+        REQUIRE(index.take_changed().size() == 1);
+
+        // Removing it
+        index.remove(vertical.get());
+        REQUIRE(index.crossings_count() == 0);
+        REQUIRE(index.crossings(horizontal.get()).empty());
+        REQUIRE(index.crossings(vertical.get()).empty());
+
+        index.clear();
+        REQUIRE(index.crossings(horizontal.get()).empty());
+    }
+
+    TEST_CASE("Updating some wires finds the same crossings as sweeping all of them")
+    {
+        wire_system::crossing_index index;
+
+        // Staircases that cross each other
+        QVector<std::shared_ptr<wire_system::wire>> wires;
+        for (int i = 0; i < 200; i++) {
+            const qreal x = (i * 37) % 500;
+            const qreal y = (i * 53) % 500;
+            auto wire = make_wire({ {x, y}, {x + 120, y}, {x + 120, y + 80}, {x + 220, y + 80}, {x + 220, y - 60} });
+            wires.append(wire);
+            index.insert(wire);
+        }
+        const int expected = count_crossings(wires);
+        REQUIRE(expected > 0);
+        REQUIRE(index.crossings_count() == expected);
+
+        // Move a few of them at a time
+        for (int round = 0; round < 20; round++) {
+            for (int i = 0; i < 10; i++) {
+                const auto& wire = wires.at((round * 61 + i * 17) % wires.count());
+                wire->move_point_to(2, wire->points().at(2).toPointF() + QPointF(0, 20));
+                wire->move_point_to(3, wire->points().at(3).toPointF() + QPointF(0, 20));
+                index.invalidate(wire.get());
+            }
+            REQUIRE(index.crossings_count() == count_crossings(wires));
+        }
+    }
+
+    TEST_CASE("The manager keeps the crossings up to date")
+    {
+        wire_system::manager manager;
+
+        auto horizontal = make_wire({ {0, 0}, {200, 0} });
+        auto vertical = make_wire({ {100, -100}, {100, 100} });
+        manager.add_wire(horizontal);
+        manager.add_wire(vertical);
+        manager.update_crossings();
+        REQUIRE(manager.crossings_count() == 1);
+
+        vertical->move_point_to(0, {300, -100});
+        vertical->move_point_to(1, {300, 100});
+        manager.update_crossings();
+        REQUIRE(manager.crossings(horizontal.get()).empty());
+
+        vertical->move_point_to(0, {100, -100});
+        vertical->move_point_to(1, {100, 100});
+        manager.update_crossings();
+        REQUIRE(manager.crossings(horizontal.get()).size() == 1);
+
+        manager.remove_wire(vertical);
+        manager.update_crossings();
+        REQUIRE(manager.crossings_count() == 0);
+    }
+
+    TEST_CASE("The crossings only change when they are updated")
+    {
+        wire_system::manager manager;
+
+        auto horizontal = make_wire({ {0, 0}, {200, 0} });
+        auto vertical = make_wire({ {100, -100}, {100, 100} });
+        manager.add_wire(horizontal);
+        manager.add_wire(vertical);
+        REQUIRE(manager.crossings(horizontal.get()).empty());
+        REQUIRE(manager.crossings_count() == 0);
+
+        manager.update_crossings();
+        REQUIRE(manager.crossings(horizontal.get()).size() == 1);
+        REQUIRE(manager.crossings(vertical.get()).size() == 1);
+
+        // Painting the wires in between doesn't search them again
+        vertical->move_point_to(0, {300, -100});
+        vertical->move_point_to(1, {300, 100});
+        REQUIRE(manager.crossings(horizontal.get()).size() == 1);
+        REQUIRE(manager.crossings_count() == 1);
+
+        manager.update_crossings();
+        REQUIRE(manager.crossings(horizontal.get()).empty());
+        REQUIRE(manager.crossings(vertical.get()).empty());
+    }
+
+    TEST_CASE("Benchmark: Crossings of 100000 wires")
+    {
+        wire_system::crossing_index index;
+
+        // A mesh of long horizontal and vertical wires
+        QVector<std::shared_ptr<wire_system::wire>> wires;
+        const int count = 100000;
+        for (int i = 0; i < count; i++) {
+            const qreal offset = ((i / 2) % 1000) * 20;
+            const qreal start = ((i * 7919) % 1000) * 20;
+            auto wire = i % 2 == 0 ? make_wire({ {start, offset}, {start + 200, offset} })
+                                   : make_wire({ {offset, start}, {offset, start + 200} });
+            wires.append(wire);
+            index.insert(wire);
+        }
+
+        // Everything is swept at once
+        auto start = std::chrono::steady_clock::now();
+        const int crossings = index.crossings_count();
+        const auto sweep = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        REQUIRE(crossings > 0);
+
+        // Then the wires are updated one by one
+        const int moves = 2000;
+        start = std::chrono::steady_clock::now();
+        for (int m = 0; m < moves; m++) {
+            const auto& wire = wires.at((m * 104729) % count);
+            wire->move(QVector2D(m % 2 == 0 ? 20 : -20, 0));
+            index.invalidate(wire.get());
+            (void)index.crossings(wire.get());
+        }
+        const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+        const double timePerMove = elapsed.count() / moves;
+
+        MESSAGE(crossings << " crossings found in " << sweep.count() << " ms, " << timePerMove << " us per move");
+    }
+}
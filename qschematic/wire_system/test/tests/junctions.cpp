@@ -0,0 +1,200 @@
+#include "../3rdparty/doctest.h"
+#include "../../manager.h"
+#include "../../wire.h"
+
+#include <QVector2D>
+
+#include <chrono>
+
+namespace
+{
+    struct comb
+    {
+        std::shared_ptr<wire_system::wire> bus;
+        QVector<std::shared_ptr<wire_system::wire>> branches;
+        QVector<std::shared_ptr<wire_system::wire>> stubs;
+    };
+
+    /**
+     * Creates a horizontal bus with vertical branches ending on it and a short stub
+     * ending on each of the branches
+     */
+    comb create_comb(wire_system::manager& manager, int count)
+    {
+        comb comb;
+        comb.bus = std::make_shared<wire_system::wire>();
+        comb.bus->append_point({0, 0});
+        comb.bus->append_point({count * 20.0, 0});
+        manager.add_wire(comb.bus);
+
+        for (int i = 0; i < count; i++) {
+            const qreal x = i * 20 + 10;
+            auto branch = std::make_shared<wire_system::wire>();
+            branch->append_point({x, -100});
+            branch->append_point({x, 0});
+            manager.add_wire(branch);
+            comb.branches.append(branch);
+
+            auto stub = std::make_shared<wire_system::wire>();
+            stub->append_point({x + 5, -50});
+            stub->append_point({x, -50});
+            manager.add_wire(stub);
+            comb.stubs.append(stub);
+        }
+        manager.generate_junctions();
+
+        return comb;
+    }
+}
+
+TEST_SUITE("Junctions")
+{
+    TEST_CASE("Junctions follow the wire they are on")
+    {
+        wire_system::manager manager;
+        Settings settings;
+        settings.gridSize = 1;
+        manager.set_settings(settings);
+
+        const auto comb = create_comb(manager, 10);
+        REQUIRE(comb.bus->connected_wires().count() == 10);
+
+        // Move the bus down
+        comb.bus->move(QVector2D(0, 20));
+
+        for (int i = 0; i < comb.branches.count(); i++) {
+            CAPTURE(i);
+            const qreal x = i * 20 + 10;
+            REQUIRE(comb.branches[i]->points().first().toPointF() == QPointF(x, -100));
+            REQUIRE(comb.branches[i]->points().last().toPointF() == QPointF(x, 20));
+            REQUIRE(comb.bus->point_is_on_wire(comb.branches[i]->points().last().toPointF()));
+            REQUIRE(comb.branches[i]->point_is_on_wire(comb.stubs[i]->points().last().toPointF()));
+        }
+    }
+
+    TEST_CASE("Wires that are connected to each other")
+    {
+        wire_system::manager manager;
+        Settings settings;
+        settings.gridSize = 1;
+        manager.set_settings(settings);
+
+        // Each wire ends on the other one
+        auto wire1 = std::make_shared<wire_system::wire>();
+        wire1->append_point({0, 0});
+        wire1->append_point({100, 0});
+        wire1->append_point({100, 50});
+        manager.add_wire(wire1);
+
+        auto wire2 = std::make_shared<wire_system::wire>();
+        wire2->append_point({50, 0});
+        wire2->append_point({50, 50});
+        wire2->append_point({150, 50});
+        manager.add_wire(wire2);
+
+        manager.generate_junctions();
+        REQUIRE(wire1->connected_wires().contains(wire2.get()));
+        REQUIRE(wire2->connected_wires().contains(wire1.get()));
+
+        // Moving one of them must terminate and keep them connected
+        wire1->move_point_by(0, QVector2D(0, -10));
+        REQUIRE(wire1->point_is_on_wire(wire2->points().first().toPointF()));
+        REQUIRE(wire2->point_is_on_wire(wire1->points().last().toPointF()));
+    }
+
+    TEST_CASE("A junction that is pushed twice in one operation ends up at the last target")
+    {
+        wire_system::manager manager;
+        Settings settings;
+        settings.gridSize = 1;
+        manager.set_settings(settings);
+
+        // A wire that ends on the first point of a vertical wire
+        auto wire1 = std::make_shared<wire_system::wire>();
+        wire1->append_point({0, 100});
+        wire1->append_point({0, 0});
+        manager.add_wire(wire1);
+
+        auto wire2 = std::make_shared<wire_system::wire>();
+        wire2->append_point({-100, 100});
+        wire2->append_point({0, 100});
+        manager.add_wire(wire2);
+
+        manager.generate_junctions();
+        REQUIRE(wire1->connected_wires().contains(wire2.get()));
+
+        // Moving the point sideways inserts a corner. The junction is first pushed along the
+        // segment that rotates and then by the point that it is on.
+        wire1->move_point_by(0, QVector2D(20, 0));
+        REQUIRE(wire1->points().first().toPointF() == QPointF(20, 100));
+        REQUIRE(wire2->points().last().toPointF() == QPointF(20, 100));
+        REQUIRE(wire1->point_is_on_wire(wire2->points().last().toPointF()));
+    }
+
+    TEST_CASE("Junctions that fall off a shortened wire are pulled back onto it")
+    {
+        wire_system::manager manager;
+        Settings settings;
+        settings.gridSize = 1;
+        manager.set_settings(settings);
+
+        auto bus = std::make_shared<wire_system::wire>();
+        bus->append_point({0, 0});
+        bus->append_point({100, 0});
+        manager.add_wire(bus);
+
+        // A branch that ends on the bus and a wire that lies on it
+        auto branch = std::make_shared<wire_system::wire>();
+        branch->append_point({80, 50});
+        branch->append_point({80, 0});
+        manager.add_wire(branch);
+
+        auto overlap = std::make_shared<wire_system::wire>();
+        overlap->append_point({20, 0});
+        overlap->append_point({90, 0});
+        manager.add_wire(overlap);
+
+        manager.generate_junctions();
+        REQUIRE(bus->connected_wires().contains(branch.get()));
+        REQUIRE(bus->connected_wires().contains(overlap.get()));
+
+        // Shortening the bus only resizes its segment
+        bus->move_point_by(1, QVector2D(-50, 0));
+        REQUIRE(bus->points().last().toPointF() == QPointF(50, 0));
+
+        // The branch follows the end of the bus
+        REQUIRE(bus->point_is_on_wire(branch->points().last().toPointF()));
+        REQUIRE(branch->points().last().is_junction());
+        REQUIRE(manager.are_connected(bus.get(), branch.get()));
+
+        // The other end of the overlapping wire keeps it connected
+        for (int index : overlap->junctions()) {
+            CAPTURE(index);
+            REQUIRE(bus->point_is_on_wire(overlap->points().at(index).toPointF()));
+        }
+        REQUIRE(manager.are_connected(bus.get(), overlap.get()));
+    }
+
+    TEST_CASE("Benchmark: Moving a bus with many T-junctions")
+    {
+        wire_system::manager manager;
+        Settings settings;
+        settings.gridSize = 1;
+        manager.set_settings(settings);
+
+        const int count = 500;
+        const auto comb = create_comb(manager, count);
+
+        const int moves = 20;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < moves; i++) {
+            comb.bus->move(QVector2D(0, (i % 2) ? -20 : 20));
+        }
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        MESSAGE(count << " T-junctions: " << elapsed.count() / moves << " ms per move");
+
+        for (const auto& branch : comb.branches) {
+            REQUIRE(comb.bus->point_is_on_wire(branch->points().last().toPointF()));
+        }
+    }
+}
@@ -50,4 +50,50 @@ TEST_SUITE("Line")
             REQUIRE(doctest::Approx(line.lenght()).epsilon(0.01) == 147.8);
         }
     }
-}
\ No newline at end of file
+
+    TEST_CASE("contains_point(): Points on the grid")
+    {
+        wire_system::line horizontal(QPointF(0, 20), QPointF(-40, 20));
+        wire_system::line vertical(QPointF(10, 0), QPointF(10, 30));
+
+        REQUIRE(horizontal.contains_point(QPointF(-20, 20)));
+        REQUIRE(horizontal.contains_point(QPointF(-40, 20)));
+        REQUIRE(horizontal.contains_point(QPointF(0, 20)));
+        REQUIRE_FALSE(horizontal.contains_point(QPointF(1, 20)));
+        REQUIRE_FALSE(horizontal.contains_point(QPointF(-20, 21)));
+        REQUIRE(vertical.contains_point(QPointF(10, 15)));
+        REQUIRE_FALSE(vertical.contains_point(QPointF(10, 31)));
+        REQUIRE_FALSE(vertical.contains_point(QPointF(11, 15)));
+
+        // Points that aren't on the grid still use the tolerance
+        REQUIRE(horizontal.contains_point(QPointF(-20, 20.005)));
+        REQUIRE_FALSE(horizontal.contains_point(QPointF(-20, 20.5)));
+        REQUIRE(horizontal.contains_point(QPointF(-20, 20.5), 1));
+
+        // A larger tolerance is still taken into account
+        REQUIRE(vertical.contains_point(QPointF(11, 15), 2));
+        REQUIRE(horizontal.contains_point(QPointF(1, 20), 0.5));
+        REQUIRE(horizontal.contains_point(QPointF(-41, 20), 0.5));
+        REQUIRE_FALSE(horizontal.contains_point(QPointF(2, 20), 0.5));
+    }
+
+    TEST_CASE("contains_point(): Points just past the ends")
+    {
+        // Both ends are extended by twice the tolerance
+        wire_system::line horizontal(QPointF(0, 20), QPointF(-40, 20));
+        REQUIRE(horizontal.contains_point(QPointF(0.015, 20)));
+        REQUIRE(horizontal.contains_point(QPointF(-40.015, 20)));
+        REQUIRE_FALSE(horizontal.contains_point(QPointF(0.03, 20)));
+        REQUIRE_FALSE(horizontal.contains_point(QPointF(-40.03, 20)));
+
+        // The ends of diagonal lines contain themselves
+        wire_system::line diagonal(QPointF(160, 1760), QPointF(240, 20));
+        REQUIRE(diagonal.contains_point(diagonal.p1()));
+        REQUIRE(diagonal.contains_point(diagonal.p2()));
+        const QPointF direction = QPointF(80, -1740) / QLineF(diagonal.p1(), diagonal.p2()).length();
+        REQUIRE(diagonal.contains_point(diagonal.p1() - direction * 0.015));
+        REQUIRE(diagonal.contains_point(diagonal.p2() + direction * 0.015));
+        REQUIRE_FALSE(diagonal.contains_point(diagonal.p1() - direction * 0.03));
+        REQUIRE_FALSE(diagonal.contains_point(diagonal.p2() + direction * 0.03));
+    }
+}
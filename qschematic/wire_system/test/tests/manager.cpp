@@ -2,6 +2,12 @@
 #include "../connector.h"
 #include "../../manager.h"
 #include "../../wire.h"
+#include "../../net.h"
+#include "../../line.h"
+#include "../../parallel.h"
+
+#include <chrono>
+#include <random>
 
 TEST_SUITE("Manager")
 {
@@ -58,6 +64,195 @@ TEST_SUITE("Manager")
         REQUIRE(wire1->net().get() == wire2->net().get());
     }
 
+    TEST_CASE ("generate_junctions(): Same result as the exhaustive search")
+    {
+        // The brute force implementation that was used before the spatial index
+        auto generateJunctionsReference = [](wire_system::manager& manager) {
+            for (const auto& wire: manager.wires()) {
+                for (auto& otherWire: manager.wires()) {
+                    if (wire == otherWire) {
+                        continue;
+                    }
+                    if (wire->point_is_on_wire(otherWire->points().first().toPointF())) {
+                        manager.connect_wire(wire.get(), otherWire.get(), 0);
+                    }
+                    if (wire->point_is_on_wire(otherWire->points().last().toPointF())) {
+                        manager.connect_wire(wire.get(), otherWire.get(), otherWire->points().count() - 1);
+                    }
+                }
+            }
+        };
+
+        for (unsigned seed = 1; seed <= 20; seed++) {
+            CAPTURE(seed);
+            std::mt19937 random(seed);
+            std::uniform_int_distribution<int> coordinate(0, 20);
+            std::uniform_int_distribution<int> pointsCount(1, 4);
+
+            // Create the same random manhattan wires in both managers
+            wire_system::manager manager1;
+            wire_system::manager manager2;
+            QVector<std::shared_ptr<wire_system::wire>> wires1;
+            QVector<std::shared_ptr<wire_system::wire>> wires2;
+            for (int i = 0; i < 60; i++) {
+                auto wire1 = std::make_shared<wire_system::wire>();
+                auto wire2 = std::make_shared<wire_system::wire>();
+                QPointF point(coordinate(random) * 20, coordinate(random) * 20);
+                const int count = pointsCount(random);
+                for (int j = 0; j < count; j++) {
+                    wire1->append_point(point);
+                    wire2->append_point(point);
+                    if (j % 2 == 0) {
+                        point.setX(coordinate(random) * 20);
+                    } else {
+                        point.setY(coordinate(random) * 20);
+                    }
+                }
+                manager1.add_wire(wire1);
+                manager2.add_wire(wire2);
+                wires1.append(wire1);
+                wires2.append(wire2);
+            }
+
+            generateJunctionsReference(manager1);
+            manager2.generate_junctions();
+
+            for (int i = 0; i < wires1.count(); i++) {
+                CAPTURE(i);
+
+                // Same junctions
+                REQUIRE(wires1[i]->points_count() == wires2[i]->points_count());
+                for (int j = 0; j < wires1[i]->points_count(); j++) {
+                    REQUIRE(wires1[i]->points().at(j).is_junction() == wires2[i]->points().at(j).is_junction());
+                }
+
+                for (int j = 0; j < wires1.count(); j++) {
+                    // Same connections
+                    REQUIRE(wires1[i]->connected_wires().contains(wires1[j].get()) ==
+                            wires2[i]->connected_wires().contains(wires2[j].get()));
+
+                    // Same nets
+                    REQUIRE((wires1[i]->net() == wires1[j]->net()) == (wires2[i]->net() == wires2[j]->net()));
+                }
+            }
+            REQUIRE(manager1.nets().count() == manager2.nets().count());
+        }
+    }
+
+    TEST_CASE ("generate_junctions(): Large designs are searched in chunks")
+    {
+        wire_system::manager manager;
+
+        // A bus with more branches than a single chunk holds
+        const int branchesCount = 5000;
+        auto bus = std::make_shared<wire_system::wire>();
+        bus->append_point({0, 0});
+        bus->append_point({(branchesCount + 1) * 20, 0});
+        manager.add_wire(bus);
+
+        QVector<std::shared_ptr<wire_system::wire>> branches;
+        QVector<QPointF> ends;
+        for (int i = 1; i <= branchesCount; i++) {
+            auto branch = std::make_shared<wire_system::wire>();
+            branch->append_point(QPointF(i * 20, 40));
+            branch->append_point(QPointF(i * 20, 0));
+            manager.add_wire(branch);
+            branches.append(branch);
+            ends.append(QPointF(i * 20, 40));
+        }
+
+        manager.generate_junctions();
+
+        REQUIRE(manager.nets().count() == 1);
+        REQUIRE(bus->connected_wires().count() == branchesCount);
+        for (int i = 0; i < branchesCount; i++) {
+            CAPTURE(i);
+            REQUIRE_FALSE(branches[i]->points().first().is_junction());
+            REQUIRE(branches[i]->points().last().is_junction());
+            REQUIRE(bus->connected_wires().at(i) == branches[i].get());
+        }
+
+        // The wires are found in the same order as the points
+        const auto found = manager.wires_with_extremity_at(ends);
+        REQUIRE(found.count() == branchesCount);
+        for (int i = 0; i < branchesCount; i++) {
+            CAPTURE(i);
+            REQUIRE(found.at(i) == branches[i].get());
+        }
+        REQUIRE(manager.wires_with_extremity_at({ QPointF(10, 40) }).first() == nullptr);
+    }
+
+    TEST_CASE ("map_chunks(): The results are in order")
+    {
+        for (int count : { 0, 1, 10, 1000, 100000 }) {
+            CAPTURE(count);
+            const auto chunks = wire_system::map_chunks<QVector<int>>(count, 100, [](int begin, int end) {
+                QVector<int> indices;
+                for (int i = begin; i < end; i++) {
+                    indices.append(i);
+                }
+                return indices;
+            });
+
+            REQUIRE_FALSE(chunks.empty());
+            int expected = 0;
+            for (const auto& chunk : chunks) {
+                for (int index : chunk) {
+                    REQUIRE(index == expected);
+                    expected++;
+                }
+            }
+            REQUIRE(expected == count);
+        }
+    }
+
+    TEST_CASE ("map_chunks(): Can be called from a chunk")
+    {
+        // The outer chunks occupy the threads of the pool
+        const auto chunks = wire_system::map_chunks<int>(64, 1, [](int begin, int end) {
+            int sum = 0;
+            for (int i = begin; i < end; i++) {
+                for (int inner : wire_system::map_chunks<int>(100, 1, [](int b, int e) { return e - b; })) {
+                    sum += inner;
+                }
+            }
+            return sum;
+        });
+
+        int sum = 0;
+        for (int chunk : chunks) {
+            sum += chunk;
+        }
+        REQUIRE(sum == 64 * 100);
+    }
+
+    TEST_CASE ("Benchmark: map_chunks() on the thread pool")
+    {
+        // About as expensive as looking up the wire at a point
+        const QLineF line(0, 0, 1000, 333);
+        const auto work = [&line](int begin, int end) {
+            int found = 0;
+            for (int i = begin; i < end; i++) {
+                found += wire_system::line::contains_point(line, QPointF(i % 1000, (i % 1000) / 3.0), 0) ? 1 : 0;
+            }
+            return found;
+        };
+
+        const int repetitions = 100;
+        for (int count : { 512, 4096, 32768 }) {
+            double times[2];
+            for (int parallel = 0; parallel < 2; parallel++) {
+                const auto start = std::chrono::steady_clock::now();
+                for (int r = 0; r < repetitions; r++) {
+                    const auto chunks = wire_system::map_chunks<int>(count, parallel ? 512 : count, work);
+                    REQUIRE_FALSE(chunks.empty());
+                }
+                times[parallel] = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count() / repetitions;
+            }
+            MESSAGE(count << " items: " << times[0] << " us on the calling thread, " << times[1] << " us in chunks of 512");
+        }
+    }
+
     TEST_CASE ("connect_wire(): Wire can be connected manually")
     {
         wire_system::manager manager;
@@ -206,6 +401,177 @@ TEST_SUITE("Manager")
         }
     }
 
+    TEST_CASE ("connector_moved(): Re-routing the attached wires")
+    {
+        wire_system::manager manager;
+        Settings settings;
+        settings.rerouteAttachedWires = true;
+        manager.set_settings(settings);
+
+        auto wire = std::make_shared<wire_system::wire>();
+        wire->append_point({0, 0});
+        wire->append_point({100, 0});
+        wire->append_point({100, 100});
+        wire->append_point({200, 100});
+        manager.add_wire(wire);
+
+        connector conn;
+        conn.pos = QPointF(200, 100);
+        manager.attach_wire_to_connector(wire.get(), &conn);
+
+        auto is_orthogonal = [](const wire_system::wire& wire) {
+            for (const auto& segment : wire.segments()) {
+                if (!segment.is_horizontal() && !segment.is_vertical()) {
+                    return false;
+                }
+            }
+            return true;
+        };
+
+        // Move the connector over several frames, the wire is re-routed once per frame
+        const QPointF positions[] = { {200, 160}, {260, 200}, {300, 40}, {200, 100}, {240, 300} };
+        for (const QPointF& position : positions) {
+            manager.begin_batch();
+            conn.pos = position - QPointF(20, 0);
+            manager.connector_moved(&conn);
+            conn.pos = position;
+            manager.connector_moved(&conn);
+            manager.commit();
+
+            CAPTURE(position);
+            REQUIRE(wire->points().last().toPointF() == position);
+            REQUIRE(manager.attached_point(&conn) == wire->points_count() - 1);
+            REQUIRE(is_orthogonal(*wire));
+
+            // The rest of the wire doesn't change
+            REQUIRE(wire->points().at(0).toPointF() == QPointF(0, 0));
+            REQUIRE(wire->points().at(1).toPointF() == QPointF(100, 0));
+        }
+
+        // Moving the connector outside of a batch
+        manager.clear_reroute_cache();
+        conn.pos = QPointF(100, 200);
+        manager.connector_moved(&conn);
+        REQUIRE(wire->points().last().toPointF() == QPointF(100, 200));
+        REQUIRE(manager.attached_point(&conn) == wire->points_count() - 1);
+        REQUIRE(is_orthogonal(*wire));
+    }
+
+    TEST_CASE ("connector_moved(): Re-routing a wire attached at both ends")
+    {
+        wire_system::manager manager;
+        Settings settings;
+        settings.rerouteAttachedWires = true;
+        manager.set_settings(settings);
+
+        auto wire = std::make_shared<wire_system::wire>();
+        wire->append_point({0, 0});
+        wire->append_point({200, 0});
+        manager.add_wire(wire);
+
+        connector conn1;
+        conn1.pos = QPointF(0, 0);
+        connector conn2;
+        conn2.pos = QPointF(200, 0);
+        manager.attach_wire_to_connector(wire.get(), 0, &conn1);
+        manager.attach_wire_to_connector(wire.get(), 1, &conn2);
+
+        manager.begin_batch();
+        conn1.pos = QPointF(0, 60);
+        conn2.pos = QPointF(200, 120);
+        manager.connector_moved(&conn1);
+        manager.connector_moved(&conn2);
+        manager.commit();
+
+        REQUIRE(wire->points().first().toPointF() == QPointF(0, 60));
+        REQUIRE(wire->points().last().toPointF() == QPointF(200, 120));
+        REQUIRE(wire->points_count() == 3);
+        REQUIRE(manager.attached_point(&conn1) == 0);
+        REQUIRE(manager.attached_point(&conn2) == 2);
+    }
+
+    TEST_CASE ("connector_moved(): Wires with junctions on the re-routed segments just follow")
+    {
+        wire_system::manager manager;
+        Settings settings;
+        settings.rerouteAttachedWires = true;
+        manager.set_settings(settings);
+
+        auto wire = std::make_shared<wire_system::wire>();
+        wire->append_point({0, 0});
+        wire->append_point({200, 0});
+        manager.add_wire(wire);
+
+        // A wire that ends on the first one
+        auto branch = std::make_shared<wire_system::wire>();
+        branch->append_point({100, 100});
+        branch->append_point({100, 0});
+        manager.add_wire(branch);
+        manager.generate_junctions();
+        REQUIRE(wire->connected_wires().contains(branch.get()));
+
+        connector conn;
+        conn.pos = QPointF(200, 0);
+        manager.attach_wire_to_connector(wire.get(), &conn);
+
+        manager.begin_batch();
+        conn.pos = QPointF(300, 0);
+        manager.connector_moved(&conn);
+        manager.commit();
+
+        REQUIRE(wire->points().last().toPointF() == QPointF(300, 0));
+        REQUIRE(wire->point_is_on_wire(branch->points().last().toPointF()));
+    }
+
+    TEST_CASE ("Benchmark: Re-routing the wires of a component with 200 pins")
+    {
+        wire_system::manager manager;
+        Settings settings;
+        settings.rerouteAttachedWires = true;
+        manager.set_settings(settings);
+
+        // Wires that leave the pins on both sides of the component and fan out downwards
+        const int pins = 200;
+        QVector<std::shared_ptr<wire_system::wire>> wires;
+        std::vector<connector> connectors(pins);
+        for (int i = 0; i < pins; i++) {
+            const qreal side = i % 2 == 0 ? -1 : 1;
+            const qreal y = (i / 2) * 20;
+            const qreal x = side * (200 + (i / 2) * 20);
+            auto wire = std::make_shared<wire_system::wire>();
+            wire->append_point(QPointF(x, 3000));
+            wire->append_point(QPointF(x, y));
+            wire->append_point(QPointF(side * 100, y));
+            manager.add_wire(wire);
+            wires.append(wire);
+
+            connectors[i].pos = QPointF(side * 100, y);
+            manager.attach_wire_to_connector(wire.get(), &connectors[i]);
+        }
+
+        // Drag the component for a while
+        const int frames = 60;
+        const auto start = std::chrono::steady_clock::now();
+        for (int frame = 1; frame <= frames; frame++) {
+            manager.begin_batch();
+            for (int i = 0; i < pins; i++) {
+                const qreal side = i % 2 == 0 ? -1 : 1;
+                connectors[i].pos = QPointF(side * 100 + (frame % 5) * 20, (i / 2) * 20 + frame * 20);
+                manager.connector_moved(&connectors[i]);
+            }
+            manager.commit();
+        }
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        manager.clear_reroute_cache();
+
+        for (int i = 0; i < pins; i++) {
+            REQUIRE(wires.at(i)->points().last().toPointF() == connectors[i].pos);
+        }
+
+        const double timePerFrame = elapsed.count() / frames;
+        MESSAGE(timePerFrame << " ms per frame");
+    }
+
     TEST_CASE("Connections are updated when a points is inserted or removed")
     {
         wire_system::manager manager;
@@ -267,4 +633,147 @@ TEST_SUITE("Manager")
         REQUIRE(manager.attached_point(&conn1) == 0);
         REQUIRE(manager.attached_point(&conn2) == 1);
     }
+
+    TEST_CASE("Only the wires that changed are simplified")
+    {
+        wire_system::manager manager;
+
+        auto wire1 = std::make_shared<wire_system::wire>();
+        wire1->append_point(QPointF(0, 0));
+        wire1->append_point(QPointF(10, 0));
+        wire1->append_point(QPointF(20, 0));
+        manager.add_wire(wire1);
+
+        auto wire2 = std::make_shared<wire_system::wire>();
+        wire2->append_point(QPointF(0, 50));
+        wire2->append_point(QPointF(10, 50));
+        wire2->append_point(QPointF(20, 50));
+        manager.add_wire(wire2);
+
+        // Only the second wire changes
+        wire2->move_point_to(2, QPointF(30, 50));
+        manager.simplify_changed_wires();
+        REQUIRE(wire1->points_count() == 3);
+        REQUIRE(wire2->points_count() == 2);
+
+        // Wires that are removed from the manager are forgotten
+        wire2->append_point(QPointF(40, 50));
+        manager.remove_wire(wire2);
+        manager.simplify_changed_wires();
+        REQUIRE(wire2->points_count() == 3);
+    }
+
+    TEST_CASE("Attachments are tracked per wire")
+    {
+        wire_system::manager manager;
+
+        // Create two wires
+        auto wire1 = std::make_shared<wire_system::wire>();
+        wire1->append_point(QPointF(0, 20));
+        wire1->append_point(QPointF(80, 20));
+        manager.add_wire(wire1);
+
+        auto wire2 = std::make_shared<wire_system::wire>();
+        wire2->append_point(QPointF(0, 100));
+        wire2->append_point(QPointF(80, 100));
+        manager.add_wire(wire2);
+
+        // Attach a connector to each end of both wires
+        connector conn1, conn2, conn3, conn4;
+        conn1.pos = QPointF(0, 20);
+        conn2.pos = QPointF(80, 20);
+        conn3.pos = QPointF(0, 100);
+        conn4.pos = QPointF(80, 100);
+        manager.attach_wire_to_connector(wire1.get(), &conn1);
+        manager.attach_wire_to_connector(wire1.get(), &conn2);
+        manager.attach_wire_to_connector(wire2.get(), &conn3);
+        manager.attach_wire_to_connector(wire2.get(), &conn4);
+
+        REQUIRE(manager.attached_connectors(wire1.get()).count() == 2);
+        REQUIRE(manager.attached_connectors(wire2.get()).count() == 2);
+
+        // A connector can only be attached once
+        manager.attach_wire_to_connector(wire2.get(), &conn1);
+        REQUIRE(manager.attached_wire(&conn1) == wire1.get());
+        REQUIRE(manager.attached_connectors(wire2.get()).count() == 2);
+
+        SUBCASE("Inserting a point only shifts the wire's own attachments")
+        {
+            wire1->insert_point(1, QPointF(40, 40));
+            REQUIRE(manager.attached_point(&conn2) == 2);
+            REQUIRE(manager.attached_point(&conn4) == 1);
+            REQUIRE(manager.point_is_attached(wire1.get(), 2));
+            REQUIRE_FALSE(manager.point_is_attached(wire2.get(), 2));
+        }
+
+        SUBCASE("Detaching a connector")
+        {
+            manager.detach_wire(&conn2);
+            REQUIRE(manager.attached_wire(&conn2) == nullptr);
+            REQUIRE(manager.attached_point(&conn2) == -1);
+            REQUIRE(manager.attached_connectors(wire1.get()).count() == 1);
+            REQUIRE_FALSE(manager.point_is_attached(wire1.get(), 1));
+
+            // The connector can be attached to another wire now
+            manager.attach_wire_to_connector(wire2.get(), 1, &conn2);
+            REQUIRE(manager.attached_wire(&conn2) == wire2.get());
+            REQUIRE(manager.attached_connectors(wire2.get()).count() == 3);
+        }
+
+        SUBCASE("Removing a wire detaches all its connectors")
+        {
+            manager.remove_wire(wire1);
+            REQUIRE(manager.attached_wire(&conn1) == nullptr);
+            REQUIRE(manager.attached_wire(&conn2) == nullptr);
+            REQUIRE(manager.attached_connectors(wire1.get()).isEmpty());
+            REQUIRE(manager.attached_wire(&conn3) == wire2.get());
+            REQUIRE(manager.attached_point(&conn4) == 1);
+        }
+
+        SUBCASE("Removing a net detaches the connectors of its wires")
+        {
+            manager.remove_net(wire1->net());
+            REQUIRE(manager.attached_wire(&conn1) == nullptr);
+            REQUIRE(manager.attached_wire(&conn2) == nullptr);
+            REQUIRE(manager.attached_connectors(wire1.get()).isEmpty());
+            REQUIRE(manager.attached_wire(&conn3) == wire2.get());
+        }
+
+        SUBCASE("Clearing the manager detaches all the connectors")
+        {
+            manager.clear();
+            REQUIRE(manager.attached_wire(&conn1) == nullptr);
+            REQUIRE(manager.attached_wire(&conn4) == nullptr);
+            REQUIRE(manager.attached_connectors(wire2.get()).isEmpty());
+        }
+    }
+
+    TEST_CASE("Removing a net forgets about the pending changes of its wires")
+    {
+        wire_system::manager manager;
+
+        auto wire1 = std::make_shared<wire_system::wire>();
+        wire1->append_point(QPointF(0, 0));
+        wire1->append_point(QPointF(10, 0));
+        wire1->append_point(QPointF(20, 0));
+        manager.add_wire(wire1);
+
+        auto wire2 = std::make_shared<wire_system::wire>();
+        wire2->append_point(QPointF(20, 0));
+        wire2->append_point(QPointF(20, 50));
+
+        // The net is removed before the batch is committed
+        manager.begin_batch();
+        manager.add_wire(wire2);
+        wire1->move_point_to(2, QPointF(30, 0));
+        manager.point_moved_by_user(*wire1, 2);
+        manager.remove_net(wire1->net());
+        manager.remove_net(wire2->net());
+        manager.commit();
+        manager.simplify_changed_wires();
+
+        REQUIRE(manager.wires().isEmpty());
+        REQUIRE(wire1->points_count() == 3);
+        REQUIRE(wire1->connected_wires().isEmpty());
+    }
 }
@@ -40,4 +40,69 @@ TEST_SUITE("Net")
         REQUIRE_FALSE(net->contains(wire1));
         REQUIRE_FALSE(net->contains(wire2));
     }
+
+    TEST_CASE("Nets can be found by their name")
+    {
+        wire_system::manager manager;
+
+        auto net1 = std::make_shared<wire_system::net>();
+        auto net2 = std::make_shared<wire_system::net>();
+        auto net3 = std::make_shared<wire_system::net>();
+        net1->set_name(QString("vcc"));
+        manager.add_net(net1);
+        manager.add_net(net2);
+        manager.add_net(net3);
+
+        REQUIRE(manager.nets_named("vcc").count() == 1);
+        REQUIRE(manager.nets_named("vcc").first().get() == net1.get());
+        REQUIRE(manager.nets_named("gnd").isEmpty());
+        REQUIRE(manager.nets_named("").isEmpty());
+
+        // Renaming a net updates the lookup
+        net2->set_name(QString("vcc"));
+        net3->set_name(QString("gnd"));
+        REQUIRE(manager.nets_named("vcc").count() == 2);
+        REQUIRE(manager.nets_named("gnd").count() == 1);
+
+        net1->set_name(QString("gnd"));
+        REQUIRE(manager.nets_named("vcc").count() == 1);
+        REQUIRE(manager.nets_named("vcc").first().get() == net2.get());
+        REQUIRE(manager.nets_named("gnd").count() == 2);
+
+        // Removed nets can't be found anymore
+        manager.remove_net(net1);
+        REQUIRE(manager.nets_named("gnd").count() == 1);
+        REQUIRE(manager.nets_named("gnd").first().get() == net3.get());
+
+        // Nets that aren't in the manager are ignored
+        net1->set_name(QString("vcc"));
+        REQUIRE(manager.nets_named("vcc").count() == 1);
+
+        manager.clear();
+        REQUIRE(manager.nets_named("vcc").isEmpty());
+        REQUIRE(manager.nets_named("gnd").isEmpty());
+    }
+
+    TEST_CASE("Merged nets keep their name")
+    {
+        wire_system::manager manager;
+
+        // Two wires that will be connected
+        auto wire1 = std::make_shared<wire_system::wire>();
+        wire1->append_point({0, 0});
+        wire1->append_point({10, 0});
+        auto wire2 = std::make_shared<wire_system::wire>();
+        wire2->append_point({5, 0});
+        wire2->append_point({5, 10});
+        manager.add_wire(wire1);
+        manager.add_wire(wire2);
+        wire2->net()->set_name(QString("clk"));
+        REQUIRE(manager.nets_named("clk").count() == 1);
+
+        manager.generate_junctions();
+
+        REQUIRE(manager.nets().count() == 1);
+        REQUIRE(manager.nets_named("clk").count() == 1);
+        REQUIRE(manager.nets_named("clk").first().get() == manager.nets().first().get());
+    }
 }
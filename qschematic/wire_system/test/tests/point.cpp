@@ -0,0 +1,90 @@
+#include "../3rdparty/doctest.h"
+#include "../../point.h"
+
+#include <QVector>
+
+#include <chrono>
+#include <type_traits>
+
+namespace
+{
+    // The layout points used to have: a virtual destructor and a separate flag
+    class legacy_point :
+        private QPointF
+    {
+    public:
+        legacy_point() = default;
+        legacy_point(const legacy_point& other) :
+            QPointF(other),
+            m_is_junction(other.m_is_junction)
+        {
+        }
+        legacy_point(qreal x, qreal y) :
+            QPointF(x, y)
+        {
+        }
+        virtual ~legacy_point() = default;
+
+        using QPointF::x;
+
+    private:
+        bool m_is_junction = false;
+    };
+
+    template<typename T>
+    double copy_time(const QVector<T>& points, int repetitions)
+    {
+        double checksum = 0;
+        const auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < repetitions; i++) {
+            QVector<T> copy = points;
+            // Force a deep copy
+            copy.data();
+            checksum += copy.at(i).x();
+        }
+        const auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+        REQUIRE(checksum >= 0);
+        return elapsed.count() / repetitions;
+    }
+}
+
+TEST_SUITE("Point")
+{
+    TEST_CASE("Points are trivially copyable")
+    {
+        REQUIRE(std::is_trivially_copyable_v<wire_system::point>);
+        REQUIRE(sizeof(wire_system::point) < sizeof(legacy_point));
+
+        wire_system::point point(10, 20);
+        point.set_is_junction(true);
+
+        wire_system::point copy = point;
+        REQUIRE(copy.is_junction());
+        REQUIRE(copy == QPointF(10, 20));
+
+        copy.set_is_junction(false);
+        REQUIRE(point.is_junction());
+        REQUIRE_FALSE(copy.is_junction());
+    }
+
+    TEST_CASE("Benchmark: Copying the points of a large design")
+    {
+        const int count = 1000000;
+        const int repetitions = 10;
+
+        QVector<wire_system::point> points;
+        QVector<legacy_point> legacyPoints;
+        points.reserve(count);
+        legacyPoints.reserve(count);
+        for (int i = 0; i < count; i++) {
+            points.append(wire_system::point(qreal(i % 1000), qreal(i / 1000)));
+            legacyPoints.append(legacy_point(i % 1000, i / 1000));
+        }
+
+        const double time = copy_time(points, repetitions);
+        const double legacyTime = copy_time(legacyPoints, repetitions);
+
+        MESSAGE("1M points: " << count * sizeof(wire_system::point) / 1024 << " KiB instead of " << count * sizeof(legacy_point) / 1024 << " KiB");
+        MESSAGE("1M points: " << time << " ms per copy instead of " << legacyTime << " ms");
+    }
+}
@@ -0,0 +1,299 @@
+#include "../3rdparty/doctest.h"
+#include "../../manager.h"
+#include "../../router.h"
+#include "../../wire.h"
+
+#include <chrono>
+
+namespace
+{
+    /**
+     * Returns whether the path is made of horizontal and vertical segments and whether
+     * none of its grid points is in the rectangle, except for the first and last one
+     */
+    bool path_avoids(const QPointF& from, const QVector<QPointF>& path, const QRectF& rect, int gridSize = 20)
+    {
+        QPointF previous = from;
+        for (const QPointF& point : path) {
+            if (previous.x() != point.x() && previous.y() != point.y()) {
+                return false;
+            }
+            const QPointF step = (point - previous) / std::max(1.0, (point - previous).manhattanLength() / gridSize);
+            for (QPointF p = previous + step; p != point; p += step) {
+                if (rect.contains(p)) {
+                    return false;
+                }
+            }
+            if (point != path.last() && rect.contains(point)) {
+                return false;
+            }
+            previous = point;
+        }
+        return true;
+    }
+}
+
+TEST_SUITE("Router")
+{
+    TEST_CASE("Points that can be joined by a straight line")
+    {
+        wire_system::router router;
+
+        REQUIRE(router.route({0, 0}, {200, 0}) == QVector<QPointF>{ {200, 0} });
+        REQUIRE(router.route({0, 0}, {0, -100}) == QVector<QPointF>{ {0, -100} });
+        REQUIRE(router.route({0, 0}, {0, 0}) == QVector<QPointF>{ {0, 0} });
+    }
+
+    TEST_CASE("Paths have as few bends as possible")
+    {
+        wire_system::router router;
+
+        // One bend for points that are not aligned
+        const auto path = router.route({0, 0}, {100, 60});
+        REQUIRE(path.count() == 2);
+        REQUIRE(path.last() == QPointF(100, 60));
+        REQUIRE(path_avoids({0, 0}, path, QRectF()));
+    }
+
+    TEST_CASE("Paths go around the obstacles")
+    {
+        wire_system::router router;
+        const QRectF obstacle(80, -40, 40, 80);
+        router.set_obstacle(&router, obstacle);
+        REQUIRE(router.obstacles_count() == 1);
+
+        // Leave in the right direction to only need two bends
+        const auto path = router.route({0, 0}, {200, 0});
+        REQUIRE(path.count() == 3);
+        REQUIRE(path.last() == QPointF(200, 0));
+        REQUIRE(path_avoids({0, 0}, path, obstacle));
+
+        // Moving the obstacle out of the way
+        router.set_obstacle(&router, obstacle.adjusted(0, 100, 0, 100));
+        REQUIRE(router.route({0, 0}, {200, 0}) == QVector<QPointF>{ {200, 0} });
+
+        // Moving it back
+        router.set_obstacle(&router, obstacle);
+        REQUIRE(router.route({0, 0}, {200, 0}).count() == 3);
+
+        // Removing it
+        router.remove_obstacle(&router);
+        REQUIRE(router.obstacles_count() == 0);
+        REQUIRE(router.route({0, 0}, {200, 0}) == QVector<QPointF>{ {200, 0} });
+    }
+
+    TEST_CASE("Paths start and end on the outline of the obstacles")
+    {
+        wire_system::router router;
+        const QRectF obstacle(-100, -100, 200, 200);
+        router.set_obstacle(&router, obstacle);
+
+        // The connectors are on the outline of the nodes
+        REQUIRE(router.route({100, 0}, {300, 0}) == QVector<QPointF>{ {300, 0} });
+
+        // Reaching the bottom of the obstacle from the side takes two bends
+        const auto path = router.route({300, 20}, {0, 100});
+        REQUIRE(path.count() == 3);
+        REQUIRE(path_avoids({300, 20}, path, obstacle));
+
+        // There's no way in or out of the inside
+        REQUIRE(router.route({0, 0}, {300, 0}).isEmpty());
+        REQUIRE(router.route({300, 0}, {0, 0}).isEmpty());
+    }
+
+    TEST_CASE("Paths cross wires but don't run along them")
+    {
+        wire_system::router router;
+
+        auto vertical = std::make_shared<wire_system::wire>();
+        vertical->append_point({100, -100});
+        vertical->append_point({100, 100});
+        router.insert(vertical);
+
+        auto horizontal = std::make_shared<wire_system::wire>();
+        horizontal->append_point({240, 0});
+        horizontal->append_point({360, 0});
+        router.insert(horizontal);
+
+        // Crossing is fine
+        REQUIRE(router.route({0, 0}, {200, 0}) == QVector<QPointF>{ {200, 0} });
+
+        // Overlapping is not
+        const auto path = router.route({200, 0}, {400, 0});
+        REQUIRE(path.count() == 3);
+        REQUIRE(path_avoids({200, 0}, path, QRectF(240, 0, 120, 0)));
+
+        // Unless the wire is the one being routed
+        REQUIRE(router.route({200, 0}, {400, 0}, horizontal.get()) == QVector<QPointF>{ {400, 0} });
+        REQUIRE(router.route({200, 0}, {400, 0}).count() == 3);
+
+        // Removed wires don't matter anymore
+        router.remove(horizontal.get());
+        REQUIRE(router.route({200, 0}, {400, 0}) == QVector<QPointF>{ {400, 0} });
+    }
+
+    TEST_CASE("The manager keeps the router up to date")
+    {
+        wire_system::manager manager;
+
+        auto wire = std::make_shared<wire_system::wire>();
+        wire->append_point({40, 0});
+        wire->append_point({160, 0});
+        manager.add_wire(wire);
+        REQUIRE(manager.route({0, 0}, {200, 0}).count() == 3);
+
+        // Moving the wire away
+        wire->move_point_to(0, {40, 100});
+        wire->move_point_to(1, {160, 100});
+        REQUIRE(manager.route({0, 0}, {200, 0}) == QVector<QPointF>{ {200, 0} });
+
+        // Moving it back and removing it
+        wire->move_point_to(0, {40, 0});
+        wire->move_point_to(1, {160, 0});
+        REQUIRE(manager.route({0, 0}, {200, 0}).count() == 3);
+        manager.remove_wire(wire);
+        REQUIRE(manager.route({0, 0}, {200, 0}) == QVector<QPointF>{ {200, 0} });
+
+        // Obstacles
+        manager.set_obstacle(&manager, QRectF(80, -40, 40, 80));
+        REQUIRE(manager.route({0, 0}, {200, 0}).count() == 3);
+        manager.clear();
+        REQUIRE(manager.route({0, 0}, {200, 0}) == QVector<QPointF>{ {200, 0} });
+    }
+
+    TEST_CASE("route_all(): Paths don't run along each other")
+    {
+        wire_system::router router;
+        router.set_obstacle(&router, QRectF(180, 60, 40, 40));
+
+        // The second connection lies on the first one
+        const QVector<QPair<QPointF, QPointF>> connections = {
+            { {0, 0}, {400, 0} },
+            { {100, 0}, {300, 0} },
+            { {200, -200}, {200, 200} },
+        };
+        wire_system::routing_report report;
+        const auto paths = router.route_all(connections, &report);
+
+        REQUIRE(paths.count() == 3);
+        REQUIRE(paths.at(0) == QVector<QPointF>{ {400, 0} });
+        REQUIRE(paths.at(1).count() == 3);
+        REQUIRE(paths.at(1).last() == QPointF(300, 0));
+
+        // Crossing is fine but not going through the obstacle
+        REQUIRE(paths.at(2).count() == 3);
+        REQUIRE(path_avoids({200, -200}, paths.at(2), QRectF(180, 60, 40, 40)));
+
+        REQUIRE(report.connections == 3);
+        REQUIRE(report.routed == 3);
+        REQUIRE(report.passes == 2);
+
+        // The paths are forgotten once they are returned
+        REQUIRE(router.route({100, 0}, {300, 0}) == QVector<QPointF>{ {300, 0} });
+    }
+
+    TEST_CASE("route_all(): Paths are ripped up to make room for other ones")
+    {
+        wire_system::router router;
+
+        // A dead end that can only be left to the right
+        int top, bottom, left;
+        router.set_obstacle(&top, QRectF(-100, -100, 200, 80));
+        router.set_obstacle(&bottom, QRectF(-100, 20, 200, 80));
+        router.set_obstacle(&left, QRectF(-100, -20, 80, 40));
+
+        // The first path blocks the way out
+        const QVector<QPair<QPointF, QPointF>> connections = {
+            { {120, 0}, {240, 0} },
+            { {0, 0}, {200, 60} },
+        };
+        wire_system::routing_report report;
+        const auto paths = router.route_all(connections, &report);
+
+        REQUIRE(report.routed == 2);
+        REQUIRE(report.ripped_up == 1);
+        REQUIRE(paths.at(1) == QVector<QPointF>{ {200, 0}, {200, 60} });
+        REQUIRE(paths.at(0).count() == 3);
+        REQUIRE(paths.at(0).last() == QPointF(240, 0));
+    }
+
+    TEST_CASE("route_all(): Connections that can't be routed")
+    {
+        wire_system::router router;
+        router.set_obstacle(&router, QRectF(-100, -100, 200, 200));
+
+        const QVector<QPair<QPointF, QPointF>> connections = {
+            { {0, 0}, {400, 0} },
+            { {200, 0}, {400, 0} },
+        };
+        wire_system::routing_report report;
+        const auto paths = router.route_all(connections, &report);
+
+        REQUIRE(paths.at(0).isEmpty());
+        REQUIRE(paths.at(1) == QVector<QPointF>{ {400, 0} });
+        REQUIRE(report.routed == 1);
+        REQUIRE(router.route_all({ }).isEmpty());
+    }
+
+    TEST_CASE("Benchmark: Routing on a sheet with 10000 nodes")
+    {
+        wire_system::manager manager;
+
+        // Nodes of 60 x 60 every 100 units
+        const int columns = 100;
+        QVector<QRectF> nodes;
+        nodes.reserve(10000);
+        for (int i = 0; i < 10000; i++) {
+            nodes.append(QRectF((i % columns) * 100, (i / columns) * 100, 60, 60));
+            manager.set_obstacle(&nodes.last(), nodes.last());
+        }
+
+        // The obstacles are only marked before the first search
+        REQUIRE(manager.route({80, 80}, {80, 180}) == QVector<QPointF>{ {80, 180} });
+
+        // Simulate the mouse moving away from a connector of a node while drawing a wire
+        const int moves = 500;
+        const QPointF from(60, 20);
+        const auto start = std::chrono::steady_clock::now();
+        for (int m = 0; m < moves; m++) {
+            const QPointF to(((m * 37) % 12) * 100 + 80, ((m * 23) % 60) * 20);
+            const auto path = manager.route(from, to);
+            REQUIRE_FALSE(path.isEmpty());
+        }
+        const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+        const double timePerRoute = elapsed.count() / moves;
+
+        MESSAGE(timePerRoute << " us per route");
+    }
+
+    TEST_CASE("Benchmark: Routing many connections at once")
+    {
+        wire_system::manager manager;
+
+        // Nodes of 60 x 60 every 160 units
+        const int columns = 100;
+        QVector<QRectF> nodes;
+        nodes.reserve(10000);
+        for (int i = 0; i < 10000; i++) {
+            nodes.append(QRectF((i % columns) * 160, (i / columns) * 160, 60, 60));
+            manager.set_obstacle(&nodes.last(), nodes.last());
+        }
+
+        // Connect the right side of nodes to the left side of nodes nearby
+        QVector<QPair<QPointF, QPointF>> connections;
+        for (int i = 0; i < 2000; i++) {
+            const int node = (i * 7919) % (nodes.count() - 3 * columns - 3);
+            const int otherNode = node + 1 + i % 3 + ((i / 3) % 3) * columns;
+            connections.append({ nodes.at(node).topRight() + QPointF(0, 20 + (i % 2) * 20),
+                                 nodes.at(otherNode).topLeft() + QPointF(0, 20 + (i % 2) * 20) });
+        }
+
+        wire_system::routing_report report;
+        const auto paths = manager.route_all(connections, &report);
+        REQUIRE(paths.count() == connections.count());
+
+        MESSAGE(report.connections_per_second() << " connections per second, " << report.routed << " of "
+                << report.connections << " routed in " << report.passes << " passes with " << report.ripped_up << " rip-ups");
+        CHECK(report.routed > report.connections * 9 / 10);
+    }
+}
@@ -0,0 +1,188 @@
+#include "../3rdparty/doctest.h"
+#include "../../manager.h"
+#include "../../spatial_index.h"
+#include "../../wire.h"
+
+#include <chrono>
+
+TEST_SUITE("Spatial index")
+{
+    TEST_CASE("Segments can be found by a point")
+    {
+        wire_system::spatial_index index;
+        index.set_cell_size(10);
+
+        // Create a long wire that spans many cells
+        auto wire = std::make_shared<wire_system::wire>();
+        wire->append_point({0, 0});
+        wire->append_point({200, 0});
+        wire->append_point({200, 50});
+        index.insert(wire);
+
+        REQUIRE(index.contains(wire.get()));
+        REQUIRE(index.wires_count() == 1);
+
+        // Find the segment the point is on
+        auto segmentAt = [&index](const QPointF& point) {
+            int result = -1;
+            index.for_each_segment_near(point, [&](const wire_system::spatial_index::segment& segment) {
+                if (segment.geometry.contains_point(point)) {
+                    result = segment.index;
+                }
+                return result < 0;
+            });
+            return result;
+        };
+
+        REQUIRE(segmentAt({105, 0}) == 0);
+        REQUIRE(segmentAt({200, 25}) == 1);
+        REQUIRE(segmentAt({105, 25}) == -1);
+
+        // Move the last point
+        wire->move_point_to(2, {200, -50});
+        index.invalidate(wire.get());
+        REQUIRE(segmentAt({200, 25}) == -1);
+        REQUIRE(segmentAt({200, -25}) == 1);
+
+        // Remove the wire
+        index.remove(wire.get());
+        REQUIRE_FALSE(index.contains(wire.get()));
+        REQUIRE(segmentAt({105, 0}) == -1);
+    }
+
+    TEST_CASE("Diagonal segments are only found in the cells that they cross")
+    {
+        wire_system::spatial_index index;
+        index.set_cell_size(10);
+
+        auto wire = std::make_shared<wire_system::wire>();
+        wire->append_point({0, 0});
+        wire->append_point({1000, 500});
+        index.insert(wire);
+
+        auto segmentsNear = [&index](const QPointF& point) {
+            int count = 0;
+            index.for_each_segment_near(point, [&](const wire_system::spatial_index::segment&) {
+                count++;
+                return true;
+            });
+            return count;
+        };
+
+        // Along the segment, also close to it across cell borders
+        for (int x = 0; x <= 1000; x += 7) {
+            const QPointF point(x, x / 2.0);
+            REQUIRE(segmentsNear(point) == 1);
+            REQUIRE(segmentsNear(point + QPointF(0, 0.5)) == 1);
+            REQUIRE(segmentsNear(point - QPointF(0.5, 0)) == 1);
+        }
+
+        // Far from the segment but inside of its bounding box
+        REQUIRE(segmentsNear({1000, 0}) == 0);
+        REQUIRE(segmentsNear({0, 500}) == 0);
+        REQUIRE(segmentsNear({500, 100}) == 0);
+    }
+
+    TEST_CASE("The manager keeps the index up to date")
+    {
+        wire_system::manager manager;
+
+        auto wire1 = std::make_shared<wire_system::wire>();
+        wire1->append_point({0, 0});
+        wire1->append_point({100, 0});
+        manager.add_wire(wire1);
+
+        auto wire2 = std::make_shared<wire_system::wire>();
+        wire2->append_point({500, 500});
+        wire2->append_point({500, 600});
+        manager.add_wire(wire2);
+
+        REQUIRE(manager.wire_with_extremity_at({100, 0}).get() == wire1.get());
+        REQUIRE(manager.wire_with_extremity_at({500, 600}).get() == wire2.get());
+        REQUIRE(manager.wire_with_extremity_at({300, 300}).get() == nullptr);
+
+        SUBCASE("Moving a point")
+        {
+            wire2->move_point_to(1, {300, 300});
+            REQUIRE(manager.wire_with_extremity_at({500, 600}).get() == nullptr);
+            REQUIRE(manager.wire_with_extremity_at({300, 300}).get() == wire2.get());
+        }
+
+        SUBCASE("Connecting to a wire that is far away")
+        {
+            wire2->move_point_to(1, {50, 0});
+            manager.point_moved_by_user(*wire2, 1);
+            REQUIRE(wire1->connected_wires().contains(wire2.get()));
+            REQUIRE(wire2->points().last().is_junction());
+            REQUIRE(wire1->net().get() == wire2->net().get());
+        }
+
+        SUBCASE("Changing the grid size")
+        {
+            Settings settings;
+            settings.gridSize = 3;
+            manager.set_settings(settings);
+            REQUIRE(manager.wire_with_extremity_at({100, 0}).get() == wire1.get());
+            REQUIRE(manager.wire_with_extremity_at({500, 600}).get() == wire2.get());
+        }
+
+        SUBCASE("Removing a wire")
+        {
+            manager.remove_wire(wire1);
+            REQUIRE(manager.wire_with_extremity_at({100, 0}).get() == nullptr);
+            REQUIRE(manager.wire_with_extremity_at({500, 600}).get() == wire2.get());
+        }
+
+        SUBCASE("Clearing the manager")
+        {
+            manager.clear();
+            REQUIRE(manager.wire_with_extremity_at({100, 0}).get() == nullptr);
+            REQUIRE(manager.wire_with_extremity_at({500, 600}).get() == nullptr);
+        }
+    }
+
+    TEST_CASE("Benchmark: Lookups don't depend on the number of wires")
+    {
+        const int queries = 2000;
+        double timePerQuery[3];
+        const int counts[3] = { 1000, 10000, 100000 };
+
+        for (int i = 0; i < 3; i++) {
+            wire_system::manager manager;
+
+            // Create L-shaped wires on a grid
+            QVector<std::shared_ptr<wire_system::wire>> wires;
+            const int columns = 100;
+            for (int w = 0; w < counts[i]; w++) {
+                const qreal x = (w % columns) * 100;
+                const qreal y = (w / columns) * 100;
+                auto wire = std::make_shared<wire_system::wire>();
+                wire->append_point({x, y});
+                wire->append_point({x + 60, y});
+                wire->append_point({x + 60, y + 60});
+                manager.add_wire(wire);
+                wires.append(wire);
+            }
+
+            // The wires are only indexed on the first lookup
+            REQUIRE(manager.wire_with_extremity_at({0, 0}).get() == wires.first().get());
+
+            const auto start = std::chrono::steady_clock::now();
+            for (int q = 0; q < queries; q++) {
+                const auto& wire = wires.at((q * 7919) % wires.count());
+
+                // Move the end point around and look it up
+                const QPointF end = wire->points().last().toPointF();
+                wire->move_point_to(2, end + QPointF(0, 20));
+                manager.point_moved_by_user(*wire, 2);
+                REQUIRE(manager.wire_with_extremity_at(end + QPointF(0, 20)).get() == wire.get());
+                wire->move_point_to(2, end);
+                manager.point_moved_by_user(*wire, 2);
+            }
+            const auto elapsed = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start);
+            timePerQuery[i] = elapsed.count() / queries;
+
+            MESSAGE(counts[i] << " wires: " << timePerQuery[i] << " us per move & lookup");
+        }
+    }
+}
@@ -0,0 +1,33 @@
+#include "../3rdparty/doctest.h"
+#include "../stress/driver.h"
+#include "../stress/invariants.h"
+#include "../../manager.h"
+
+TEST_SUITE("Stress")
+{
+    TEST_CASE("Random operations keep the invariants")
+    {
+        for (unsigned seed = 1; seed <= 3; seed++) {
+            CAPTURE(seed);
+
+            wire_system::manager manager;
+            Settings settings;
+            settings.gridSize = 1;
+            manager.set_settings(settings);
+            stress::driver driver(manager, seed, 30);
+
+            for (int batch = 0; batch < 30; batch++) {
+                for (int i = 0; i < 100; i++) {
+                    driver.step();
+                }
+
+                const int step = driver.steps();
+                const QStringList violations = stress::check_invariants(manager, driver.connectors(), true);
+                const std::string violation = violations.isEmpty() ? std::string() : violations.first().toStdString();
+                CAPTURE(step);
+                CAPTURE(violation);
+                REQUIRE(violations.isEmpty());
+            }
+        }
+    }
+}
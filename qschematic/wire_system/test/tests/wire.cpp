@@ -52,6 +52,51 @@ TEST_SUITE("Wire")
         REQUIRE(wire->points_count() == 2);
     }
 
+    TEST_CASE("Simplifying keeps the corners and the junctions")
+    {
+        auto wire = std::make_shared<wire_system::wire>();
+        wire->append_point(QPointF(0, 0));
+        wire->append_point(QPointF(10, 0));
+        wire->append_point(QPointF(10, 0));
+        wire->append_point(QPointF(20, 0));
+        wire->append_point(QPointF(30, 0));
+        wire->append_point(QPointF(30, 10));
+        wire->append_point(QPointF(30, 20));
+        wire->append_point(QPointF(30, 20));
+        wire->set_point_is_junction(7, true);
+
+        wire->simplify();
+
+        REQUIRE(wire->points_count() == 3);
+        REQUIRE(wire->points().at(0) == QPointF(0, 0));
+        REQUIRE(wire->points().at(1) == QPointF(30, 0));
+        REQUIRE(wire->points().at(2) == QPointF(30, 20));
+        REQUIRE(wire->points().at(2).is_junction());
+    }
+
+    TEST_CASE("Simplifying a wire with many points")
+    {
+        // A staircase with every step split in many collinear points
+        auto wire = std::make_shared<wire_system::wire>();
+        const int steps = 1000;
+        for (int step = 0; step < steps; step++) {
+            for (int i = 0; i < 20; i++) {
+                wire->append_point(QPointF(step * 20 + i, step * 20));
+            }
+            wire->append_point(QPointF(step * 20 + 20, step * 20));
+            wire->append_point(QPointF(step * 20 + 20, step * 20));
+        }
+
+        wire->simplify();
+
+        // Every step has a horizontal and a vertical segment
+        REQUIRE(wire->points_count() == steps * 2);
+        for (int i = 0; i < wire->points_count() - 1; i++) {
+            CAPTURE(i);
+            REQUIRE((wire->segment(i).is_horizontal() || wire->segment(i).is_vertical()));
+        }
+    }
+
     TEST_CASE("Wires can be moved")
     {
         // Use a grid size of 1
@@ -0,0 +1,142 @@
+#include "../3rdparty/doctest.h"
+#include "../../manager.h"
+#include "../../net.h"
+#include "../../wire.h"
+#include "../../wire_pool.h"
+
+TEST_SUITE("Wire pool")
+{
+    TEST_CASE("Released handles become stale")
+    {
+        wire_system::wire_pool pool;
+
+        auto wire1 = std::make_shared<wire_system::wire>();
+        auto wire2 = std::make_shared<wire_system::wire>();
+        const auto handle1 = pool.acquire(wire1);
+
+        REQUIRE_FALSE(handle1.is_null());
+        REQUIRE(pool.get(handle1) == wire1.get());
+        REQUIRE(pool.shared(handle1).get() == wire1.get());
+        REQUIRE(pool.find(wire1.get()) == handle1);
+        REQUIRE(pool.count() == 1);
+
+        // The slot is reused but the old handle doesn't refer to the new wire
+        pool.release(handle1);
+        const auto handle2 = pool.acquire(wire2);
+        REQUIRE(handle2.index == handle1.index);
+        REQUIRE(handle2 != handle1);
+        REQUIRE(pool.get(handle1) == nullptr);
+        REQUIRE(pool.shared(handle1).get() == nullptr);
+        REQUIRE(pool.get(handle2) == wire2.get());
+        REQUIRE(pool.find(wire1.get()).is_null());
+
+        // Releasing a stale handle does nothing
+        pool.release(handle1);
+        REQUIRE(pool.get(handle2) == wire2.get());
+        REQUIRE(pool.count() == 1);
+    }
+
+    TEST_CASE("A wire acquired twice is kept until both are released")
+    {
+        wire_system::wire_pool pool;
+
+        auto wire = std::make_shared<wire_system::wire>();
+        const auto handle = pool.acquire(wire);
+        REQUIRE(pool.acquire(wire) == handle);
+
+        pool.release(handle);
+        REQUIRE(pool.get(handle) == wire.get());
+
+        pool.release(handle);
+        REQUIRE(pool.get(handle) == nullptr);
+        REQUIRE(pool.count() == 0);
+    }
+
+    TEST_CASE("Nets store their wires in the pool of the manager")
+    {
+        wire_system::manager manager;
+
+        // The wire is added to a net that isn't managed yet
+        auto wire = std::make_shared<wire_system::wire>();
+        wire->append_point({0, 0});
+        wire->append_point({10, 0});
+        auto net = std::make_shared<wire_system::net>();
+        net->addWire(wire);
+        REQUIRE(manager.pool()->count() == 0);
+
+        manager.add_net(net);
+        REQUIRE(manager.pool()->count() == 1);
+        REQUIRE(net->wires_count() == 1);
+        REQUIRE(net->wires().first().get() == wire.get());
+
+        // Moving the wire to another net keeps it in the pool
+        auto otherNet = std::make_shared<wire_system::net>();
+        manager.add_net(otherNet);
+        const auto handle = manager.pool()->find(wire.get());
+        otherNet->take_wires(net, net->wires());
+        REQUIRE(manager.pool()->find(wire.get()) == handle);
+        REQUIRE(otherNet->contains(wire));
+        REQUIRE_FALSE(net->contains(wire));
+
+        // Removing the wire releases it
+        manager.remove_wire(wire);
+        REQUIRE(manager.pool()->count() == 0);
+        REQUIRE(manager.pool()->get(handle) == nullptr);
+    }
+
+    TEST_CASE("Destroying a net releases its wires")
+    {
+        wire_system::manager manager;
+
+        auto wire = std::make_shared<wire_system::wire>();
+        wire->append_point({0, 0});
+        wire->append_point({10, 0});
+        manager.add_wire(wire);
+        REQUIRE(manager.pool()->count() == 1);
+
+        // The wire keeps its net alive
+        manager.clear();
+        REQUIRE(manager.pool()->count() == 1);
+        REQUIRE(wire->net()->wires().first().get() == wire.get());
+
+        wire.reset();
+        REQUIRE(manager.pool()->count() == 0);
+    }
+
+    TEST_CASE("Wires that have been destroyed are skipped")
+    {
+        wire_system::manager manager;
+
+        auto wire1 = std::make_shared<wire_system::wire>();
+        auto wire2 = std::make_shared<wire_system::wire>();
+        auto net = std::make_shared<wire_system::net>();
+        manager.add_net(net);
+        net->addWire(wire1);
+        net->addWire(wire2);
+        const auto handle = manager.pool()->find(wire1.get());
+
+        // The net still refers to the wire
+        const wire_system::wire* destroyed = wire1.get();
+        wire1.reset();
+        REQUIRE(manager.pool()->get(handle) == nullptr);
+        REQUIRE(manager.pool()->shared(handle).get() == nullptr);
+        REQUIRE(manager.pool()->address(handle) == destroyed);
+
+        int count = 0;
+        for (auto* wire : net->raw_wires()) {
+            REQUIRE(wire == wire2.get());
+            count++;
+        }
+        REQUIRE(count == 1);
+        REQUIRE(net->wires().count() == 1);
+
+        // A new wire at the same address doesn't inherit the old handle
+        auto wire3 = std::make_shared<wire_system::wire>();
+        const auto newHandle = manager.pool()->acquire(wire3);
+        if (wire3.get() == destroyed) {
+            REQUIRE(newHandle != handle);
+            REQUIRE(manager.pool()->get(handle) == nullptr);
+        }
+        REQUIRE(manager.pool()->get(newHandle) == wire3.get());
+    }
+}
@@ -9,6 +9,160 @@
 
 using namespace wire_system;
 
+// How often the same junction can be moved during one operation
+const int MAX_JUNCTION_MOVES = 4;
+
+namespace
+{
+    /**
+     * Moving a point of a wire can require moving the junctions of the wires connected to it,
+     * which in turn can require moving the junctions of the wires connected to those and so on.
+     * Instead of recursing, the junctions that have to move are queued and moved once the
+     * operation that caused them is done. While the move of a junction is queued, the first
+     * push wins: the later ones are computed from the same outdated position. Once it has been
+     * moved a junction can be queued again, but only a few times per operation so that cycles
+     * of wires can't keep pushing each other.
+     * Once no move is left, the junctions that still aren't on a wire that changed during the
+     * operation are pulled back onto it, e.g. after a corner it was on has been removed. At
+     * last the manager gets to disconnect the wires whose junctions couldn't follow.
+     * An instance has to exist during every operation that can move junctions. The queue is
+     * processed when the outermost one is destroyed.
+     */
+    class junction_propagation
+    {
+    public:
+        junction_propagation();
+        junction_propagation(const junction_propagation&) = delete;
+        ~junction_propagation();
+
+        static quint64 operation();
+        static int queue(wire* wire, bool last, const QPointF& target, bool preserveAngles);
+        static bool is_pending(int slot);
+        static bool changed(wire* wire, manager* manager);
+
+    private:
+        struct junction_move
+        {
+            wire* owner;
+            bool last;              // Whether it's the last point or the first one
+            QPointF target;
+            bool preserveAngles;
+        };
+
+        struct changed_wire
+        {
+            wire* owner;
+            manager* wireManager;
+        };
+
+        struct state
+        {
+            QVector<junction_move> moves;
+            int next = 0;           // The first move that hasn't been processed yet
+            QVector<changed_wire> changed;  // A wire is listed again if it changes after its junctions were pulled
+            quint64 operation = 0;
+            int depth = 0;
+        };
+
+        static thread_local state s_state;
+    };
+
+    thread_local junction_propagation::state junction_propagation::s_state;
+
+    junction_propagation::junction_propagation()
+    {
+        // A new operation starts
+        if (s_state.depth == 0) {
+            s_state.operation++;
+        }
+        s_state.depth++;
+    }
+
+    junction_propagation::~junction_propagation()
+    {
+        if (s_state.depth > 1) {
+            s_state.depth--;
+            return;
+        }
+
+        // The moves can queue more moves. They are part of the same operation.
+        int checked = 0;
+        while (s_state.next < s_state.moves.count() || checked < s_state.changed.count()) {
+            if (s_state.next == s_state.moves.count()) {
+                s_state.changed.at(checked++).owner->pull_junctions();
+                continue;
+            }
+
+            const junction_move move = s_state.moves.at(s_state.next++);
+            const int index = move.last ? move.owner->points_count() - 1 : 0;
+            if (index < 0) {
+                continue;
+            }
+            const QPointF current = move.owner->points().at(index).toPointF();
+            if (current == move.target) {
+                continue;
+            }
+            if (move.preserveAngles) {
+                move.owner->move_point_by(index, QVector2D(move.target - current));
+            } else {
+                move.owner->move_point_to(index, move.target);
+            }
+        }
+
+        s_state.moves.clear();
+        s_state.next = 0;
+        s_state.depth--;
+
+        // Nothing is queued anymore, the manager can modify the wires. Swapping keeps the
+        // capacity of the list without letting the manager modify it while it's iterated.
+        QVector<changed_wire> changed;
+        changed.swap(s_state.changed);
+        for (const auto& changedWire : changed) {
+            if (changedWire.wireManager) {
+                changedWire.wireManager->wire_settled(changedWire.owner);
+            }
+        }
+        changed.clear();
+        s_state.changed.swap(changed);
+    }
+
+    quint64 junction_propagation::operation()
+    {
+        return s_state.operation;
+    }
+
+    /**
+     * Queues a move and returns its slot
+     */
+    int junction_propagation::queue(wire* wire, bool last, const QPointF& target, bool preserveAngles)
+    {
+        s_state.moves.append({ wire, last, target, preserveAngles });
+        return s_state.moves.count() - 1;
+    }
+
+    /**
+     * Returns whether a queued move hasn't been processed yet
+     */
+    bool junction_propagation::is_pending(int slot)
+    {
+        return slot >= s_state.next && slot < s_state.moves.count();
+    }
+
+    /**
+     * Records that the points of a wire changed during the operation.
+     * \return false if there is no operation in progress
+     */
+    bool junction_propagation::changed(wire* wire, manager* manager)
+    {
+        if (s_state.depth == 0) {
+            return false;
+        }
+
+        s_state.changed.append({ wire, manager });
+        return true;
+    }
+}
+
 wire::wire() : m_manager(nullptr)
 {
 }
@@ -18,7 +172,7 @@ void wire::set_manager(wire_system::manager* manager)
     m_manager = manager;
 }
 
-QVector<point> wire::points() const
+const QVector<point>& wire::points() const
 {
     return m_points;
 }
@@ -28,12 +182,12 @@ int wire::points_count() const
     return m_points.count();
 }
 
-QVector<int> wire::junctions() const
+QVarLengthArray<int, 2> wire::junctions() const
 {
     if (points_count() < 2) {
         return {};
     }
-    QVector<int> indexes;
+    QVarLengthArray<int, 2> indexes;
     if (m_points.first().is_junction()) {
         indexes.append(0);
     }
@@ -43,7 +197,7 @@ QVector<int> wire::junctions() const
     return indexes;
 }
 
-QList<wire*> wire::connected_wires()
+const QList<wire*>& wire::connected_wires() const
 {
     return m_connectedWires;
 }
@@ -63,8 +217,27 @@ QList<line> wire::line_segments() const
     return ret;
 }
 
+/**
+ * Returns a view of the line segments that doesn't allocate. Prefer this over
+ * line_segments() when iterating.
+ */
+wire::segment_view wire::segments() const
+{
+    return segment_view(m_points);
+}
+
+/**
+ * Returns the line segment that starts at the point with the given index
+ */
+line wire::segment(int index) const
+{
+    return line(m_points.at(index).toPointF(), m_points.at(index + 1).toPointF());
+}
+
 void wire::move_junctions_to_new_segment(const line& oldSegment, const line& newSegment)
 {
+    junction_propagation propagation;
+
     // Do nothing if the segment was just resized
     if (qFuzzyCompare(oldSegment.toLineF().angle(), newSegment.toLineF().angle())) {
         return;
@@ -73,19 +246,19 @@ void wire::move_junctions_to_new_segment(const line& oldSegment, const line& new
     // Move connected junctions
     for (const auto& wire: m_connectedWires) {
         for (const auto& jIndex: wire->junctions()) {
-            point point = wire->points().at(jIndex);
+            const point point = wire->points().at(jIndex);
             // Check if the point is on the old segment
             if (oldSegment.contains_point(point.toPoint(), 5)) {
                 line junctionSeg;
                 // Find out if one of the segments is horizontal or vertical
-                if (jIndex < wire->points().count() - 1) {
-                    line seg = wire->line_segments().at(jIndex);
+                if (jIndex < wire->points_count() - 1) {
+                    line seg = wire->segment(jIndex);
                     if (seg.is_horizontal() || seg.is_vertical()) {
                         junctionSeg = seg;
                     }
                 }
                 if (jIndex > 0) {
-                    line seg = wire->line_segments().at(jIndex - 1);
+                    line seg = wire->segment(jIndex - 1);
                     if (seg.is_horizontal() || seg.is_vertical()) {
                         junctionSeg = seg;
                     }
@@ -98,17 +271,23 @@ void wire::move_junctions_to_new_segment(const line& oldSegment, const line& new
 #                   else
                         auto type = junctionSeg.toLineF().intersect(newSegment.toLineF(), &intersection);
 #                   endif
-                    if (type != QLineF::NoIntersection) {
-                        wire->move_point_by(jIndex, QVector2D(intersection - point.toPointF()));
+                    if (type == QLineF::NoIntersection) {
+                        continue;
+                    }
+                    // Almost parallel lines intersect far away from the new segment
+                    if (newSegment.contains_point(intersection, 1)) {
+                        wire->move_junction_by(jIndex, QVector2D(intersection - point.toPointF()));
+                        continue;
                     }
                 }
-                    // Move the point along the segment so that it stays at the same proportional distance from the two points
-                else {
-                    QPointF d = point.toPointF() - oldSegment.p1();
-                    qreal ratio = QVector2D(d).length() / oldSegment.lenght();
-                    QPointF pos = newSegment.toLineF().pointAt(ratio);
-                    wire->move_point_by(jIndex, QVector2D(pos - point.toPointF()));
-                }
+
+                // Move the point along the segment so that it stays at the same proportional distance from the two points
+                QPointF d = point.toPointF() - oldSegment.p1();
+                // The point is only close to the segment, make sure that it ends up on the new one
+                const qreal length = oldSegment.lenght();
+                qreal ratio = qFuzzyIsNull(length) ? 0 : qBound<qreal>(0, QVector2D(d).length() / length, 1);
+                QPointF pos = newSegment.toLineF().pointAt(ratio);
+                wire->move_junction_by(jIndex, QVector2D(pos - point.toPointF()));
             }
         }
     }
@@ -116,6 +295,8 @@ void wire::move_junctions_to_new_segment(const line& oldSegment, const line& new
 
 void wire::move_point_to(int index, const QPointF& moveTo)
 {
+    junction_propagation propagation;
+
     if (index < 0 || index > points_count() - 1) {
         return;
     }
@@ -128,23 +309,23 @@ void wire::move_point_to(int index, const QPointF& moveTo)
     // Move junctions that are on the point
     for (const auto& wire: m_connectedWires) {
         for (const auto& jIndex: wire->junctions()) {
-            point point = wire->points().at(jIndex);
+            const point point = wire->points().at(jIndex);
             if ((m_points[index]).toPoint() == point.toPoint()) {
-                wire->move_point_by(jIndex, QVector2D(moveTo - m_points[index].toPointF()));
+                wire->move_junction_by(jIndex, QVector2D(moveTo - m_points[index].toPointF()));
             }
         }
     }
 
     // Move junctions on the next segment
     if (index < points_count() - 1) {
-        line segment = line_segments().at(index);
+        line segment = this->segment(index);
         line newSegment(moveTo, points().at(index + 1).toPointF());
         move_junctions_to_new_segment(segment, newSegment);
     }
 
     // Move junctions on the previous segment
     if (index > 0) {
-        line segment = line_segments().at(index - 1);
+        line segment = this->segment(index - 1);
         line newSegment(points().at(index - 1).toPointF(), moveTo);
         move_junctions_to_new_segment(segment, newSegment);
     }
@@ -152,6 +333,7 @@ void wire::move_point_to(int index, const QPointF& moveTo)
     point wirepoint = moveTo;
     wirepoint.set_is_junction(m_points[index].is_junction());
     m_points[index] = wirepoint;
+    points_changed();
 }
 
 /**
@@ -187,6 +369,7 @@ void wire::prepend_point(const QPointF& point)
 {
     about_to_change();
     m_points.prepend(wire_system::point(point));
+    points_changed();
     has_changed();
 
     // Update junction
@@ -202,6 +385,7 @@ void wire::append_point(const QPointF& point)
 {
     about_to_change();
     m_points.append(wire_system::point(point));
+    points_changed();
     has_changed();
 
     // Update junction
@@ -217,6 +401,8 @@ void wire::append_point(const QPointF& point)
 
 void wire::move_line_segment_by(int index, const QVector2D& moveBy)
 {
+    junction_propagation propagation;
+
     // Do nothing if not moving
     if (moveBy.isNull()) {
         return;
@@ -230,20 +416,20 @@ void wire::move_line_segment_by(int index, const QVector2D& moveBy)
     // Move connected junctions
     for (const auto& wire: m_connectedWires) {
         for (const auto& jIndex: wire->junctions()) {
-            point point = wire->points().at(jIndex);
-            line segment = line_segments().at(index);
+            const point point = wire->points().at(jIndex);
+            line segment = this->segment(index);
             if (segment.contains_point(point.toPointF())) {
                 // Don't move it if it is on one of the points
                 if (segment.p1().toPoint() == point.toPoint() || segment.p2().toPoint() == point.toPoint()) {
                     continue;
                 }
-                wire->move_point_by(jIndex, moveBy);
+                wire->move_junction_by(jIndex, moveBy);
             }
         }
     }
 
     // If this is the first or last segment we might need to add a new segment
-    if (index == 0 || index == line_segments().count() - 1) {
+    if (index == 0 || index == segments().count() - 1) {
         // Get the correct point
         point point;
         if (index == 0) {
@@ -293,33 +479,35 @@ void wire::add_segment(int index)
 
 void wire::insert_point(int index, const QPointF& point)
 {
+    junction_propagation propagation;
+
     // Boundary check
     if (index < 0 || index >= points_count()) {
         return;
     }
 
-    line segment = line_segments().at(index - 1);
+    // The junctions have to end up on the point that is actually inserted
+    const QPointF position = m_manager ? m_manager->settings().snapToGrid(point) : point;
+
+    line segment = this->segment(index - 1);
     // If the point is not on the segment, move the junctions
-    if (!segment.contains_point(point)) {
+    if (!segment.contains_point(position)) {
         // Find the closest point on the segment
-        QPointF closestPoint = Utils::pointOnLineClosestToPoint(segment.p1(), segment.p2(), point);
+        QPointF closestPoint = Utils::pointOnLineClosestToPoint(segment.p1(), segment.p2(), position);
         // Create two line that split the segment at the closest point
         line seg1(segment.p1(), closestPoint);
         line seg2(closestPoint, segment.p2());
         // Calculate what will be the new segments
-        line seg1new(segment.p1(), point);
-        line seg2new(point, segment.p2());
+        line seg1new(segment.p1(), position);
+        line seg2new(position, segment.p2());
         // Move the junction on both lines
         move_junctions_to_new_segment(seg1, seg1new);
         move_junctions_to_new_segment(seg2, seg2new);
     }
 
     about_to_change();
-    if (m_manager) {
-        m_points.insert(index, wire_system::point(m_manager->settings().snapToGrid(point)));
-    } else {
-        m_points.insert(index, point);
-    }
+    m_points.insert(index, position);
+    points_changed();
     has_changed();
 
     if (m_manager) {
@@ -329,6 +517,8 @@ void wire::insert_point(int index, const QPointF& point)
 
 void wire::move_point_by(int index, const QVector2D& moveBy)
 {
+    junction_propagation propagation;
+
     if (index < 0 || index > points_count() - 1) {
         return;
     }
@@ -342,7 +532,7 @@ void wire::move_point_by(int index, const QVector2D& moveBy)
     // straight angles, we need to insert two additional points if we are not moving in
     // the direction of the line.
     if (points_count() == 2 && m_manager->settings().preserveStraightAngles) {
-        const line line = line_segments().first();
+        const line line = segment(0);
 
         bool moveVertically = line.is_horizontal() && !qFuzzyIsNull(moveBy.y());
         bool moveHorizontally = line.is_vertical() && !qFuzzyIsNull(moveBy.x());
@@ -405,16 +595,16 @@ void wire::move_point_by(int index, const QVector2D& moveBy)
                 // Move connected junctions
                 for (const auto& wire: m_connectedWires) {
                     for (const auto& jIndex: wire->junctions()) {
-                        const auto& point = wire->points().at(jIndex);
+                        const point point = wire->points().at(jIndex);
                         if (line.contains_point(point.toPointF())) {
                             // Don't move it if it is on one of the points
                             if (line.p1().toPoint() == point.toPoint() || line.p2().toPoint() == point.toPoint()) {
                                 continue;
                             }
                             if (line.is_horizontal()) {
-                                wire->move_point_by(jIndex, QVector2D(0, moveBy.y()));
+                                wire->move_junction_by(jIndex, QVector2D(0, moveBy.y()));
                             } else {
-                                wire->move_point_by(jIndex, QVector2D(moveBy.x(), 0));
+                                wire->move_junction_by(jIndex, QVector2D(moveBy.x(), 0));
                             }
                         }
                     }
@@ -445,16 +635,16 @@ void wire::move_point_by(int index, const QVector2D& moveBy)
                 // Move connected junctions
                 for (const auto& wire: m_connectedWires) {
                     for (const auto& jIndex: wire->junctions()) {
-                        const auto& point = wire->points().at(jIndex);
+                        const point point = wire->points().at(jIndex);
                         if (line.contains_point(point.toPointF())) {
                             // Don't move it if it is on one of the points
                             if (line.p1().toPoint() == point.toPoint() || line.p2().toPoint() == point.toPoint()) {
                                 continue;
                             }
                             if (line.is_horizontal()) {
-                                wire->move_point_by(jIndex, QVector2D(0, moveBy.y()));
+                                wire->move_junction_by(jIndex, QVector2D(0, moveBy.y()));
                             } else {
-                                wire->move_point_by(jIndex, QVector2D(moveBy.x(), 0));
+                                wire->move_junction_by(jIndex, QVector2D(moveBy.x(), 0));
                             }
                         }
                     }
@@ -477,7 +667,7 @@ void wire::move_point_by(int index, const QVector2D& moveBy)
 
 bool wire::point_is_on_wire(const QPointF& point) const
 {
-    for (const line& lineSegment : line_segments()) {
+    for (const line& lineSegment : segments()) {
         if (lineSegment.contains_point(point, 0)) {
             return true;
         }
@@ -488,6 +678,8 @@ bool wire::point_is_on_wire(const QPointF& point) const
 
 void wire::move(const QVector2D& movedBy)
 {
+    junction_propagation propagation;
+
     // Ignore if it shouldn't move
     if (movedBy.isNull()) {
         return;
@@ -495,8 +687,8 @@ void wire::move(const QVector2D& movedBy)
 
     // Move junctions
     for (const auto& index : junctions()) {
-        const auto& junction = points().at(index);
-        for (const auto& wire : net()->wires()) {
+        const point junction = points().at(index);
+        for (auto* wire : net()->raw_wires()) {
             if (!wire->connected_wires().contains(this)) {
                 continue;
             }
@@ -509,9 +701,9 @@ void wire::move(const QVector2D& movedBy)
     // Move junction on the wire
     for (const auto& wire : connected_wires()) {
         for (const auto& index : wire->junctions()) {
-            const auto& point = wire->points().at(index);
+            const point point = wire->points().at(index);
             if (point_is_on_wire(point.toPointF())) {
-                wire->move_point_by(index, movedBy);
+                wire->move_junction_by(index, movedBy);
             }
         }
     }
@@ -522,52 +714,67 @@ void wire::move(const QVector2D& movedBy)
     }
 }
 
+/**
+ * Removes the points that are at the same position as the previous one. The points
+ * that are kept are compacted at the front of the vector in a single pass.
+ */
 void wire::remove_duplicate_points()
 {
-    int i = 0;
-    while (i < points_count() - 1 && points_count() > 2) {
-        point p1 = points().at(i);
-        point p2 = points().at(i + 1);
+    const int count = points_count();
+    if (count < 3) {
+        return;
+    }
+
+    int kept = 1;
+    for (int i = 1; i < count; i++) {
+        // Keep at least two points
+        const bool canRemove = kept + (count - i) > 2;
 
-        // Check if p2 is the same as p1
-        if (p1 == p2) {
-            // If p1 is not a junction itself then inherit from p2
-            if (!p1.is_junction()) {
-                set_point_is_junction(i, p2.is_junction());
+        // Check if the point is the same as the last one that was kept
+        if (canRemove && m_points.at(kept - 1) == m_points.at(i)) {
+            // If the kept point is not a junction itself then inherit from the removed one
+            if (!m_points.at(kept - 1).is_junction()) {
+                m_points[kept - 1].set_is_junction(m_points.at(i).is_junction());
             }
             if (m_manager) {
-                m_manager->point_removed(this, i + 1);
+                m_manager->point_removed(this, kept);
             }
-            m_points.removeAt(i + 1);
         } else {
-            i++;
+            m_points[kept++] = m_points.at(i);
         }
     }
+    m_points.resize(kept);
 }
 
+/**
+ * Removes the points that are on the line between their neighbours. The points
+ * that are kept are compacted at the front of the vector in a single pass.
+ */
 void wire::remove_obsolete_points()
 {
     // Don't do anything if there are not at least three line segments
-    if (points_count() < 3) {
+    const int count = points_count();
+    if (count < 3) {
         return;
     }
 
-    // Compile a list of obsolete points
-    auto it = m_points.begin() + 2;
-    while (it != m_points.end()) {
-        QPointF p1 = (*(it - 2)).toPointF();
-        QPointF p2 = (*(it - 1)).toPointF();
-        QPointF p3 = (*it).toPointF();
+    int kept = 2;
+    for (int i = 2; i < count; i++) {
+        QPointF p1 = m_points.at(kept - 2).toPointF();
+        QPointF p2 = m_points.at(kept - 1).toPointF();
+        QPointF p3 = m_points.at(i).toPointF();
 
         // Check if p2 is on the line created by p1 and p3
         if (Utils::pointIsOnLine(QLineF(p1, p2), p3)) {
             if (m_manager) {
-                m_manager->point_removed(this, m_points.indexOf(*(it - 1)));
+                m_manager->point_removed(this, kept - 1);
             }
-            it = m_points.erase(it - 1);
+            m_points[kept - 1] = m_points.at(i);
+        } else {
+            m_points[kept++] = m_points.at(i);
         }
-        it++;
     }
+    m_points.resize(kept);
 }
 
 void wire::simplify()
@@ -575,7 +782,12 @@ void wire::simplify()
     about_to_change();
     remove_duplicate_points();
     remove_obsolete_points();
+    points_changed();
     has_changed();
+
+    if (m_manager) {
+        m_manager->wire_simplified(this);
+    }
 }
 
 bool wire::connect_wire(wire* wire)
@@ -592,7 +804,7 @@ void wire::setNet(const std::shared_ptr<wire_system::net>& net)
     m_net = net;
 }
 
-std::shared_ptr<wire_system::net> wire::net()
+std::shared_ptr<wire_system::net> wire::net() const
 {
     return m_net;
 }
@@ -607,28 +819,150 @@ manager* wire::manager()
     return m_manager;
 }
 
+/**
+ * Moves the first or last point because it is a junction on a wire that changed.
+ * The point is moved once the current operation is done.
+ */
+void wire::move_junction_by(int index, const QVector2D& moveBy)
+{
+    queue_junction_move(index, m_points.at(index).toPointF() + moveBy.toPointF(), true);
+}
+
+/**
+ * Moves the junctions of the connected wires that are no longer on this wire back onto it.
+ * Of the junctions of a connected wire, the one closest to this wire is moved to the closest
+ * point on it.
+ */
+void wire::pull_junctions()
+{
+    m_unsettled_operation = 0;
+
+    for (auto* wire : m_connectedWires) {
+        int closest = -1;
+        QPointF closestTarget;
+        qreal closestDistance = 0;
+        for (int jIndex : wire->junctions()) {
+            const QPointF junction = wire->points().at(jIndex).toPointF();
+            if (point_is_on_wire(junction)) {
+                closest = -1;
+                break;
+            }
+            const QPointF target = point_closest_to(junction);
+            const qreal distance = QVector2D(target - junction).lengthSquared();
+            if (closest < 0 || distance < closestDistance) {
+                closest = jIndex;
+                closestTarget = target;
+                closestDistance = distance;
+            }
+        }
+
+        if (closest >= 0) {
+            wire->move_junction_by(closest, QVector2D(closestTarget - wire->points().at(closest).toPointF()));
+        }
+    }
+}
+
+/**
+ * Returns the point on the wire that is the closest to the given point
+ */
+QPointF wire::point_closest_to(const QPointF& point) const
+{
+    QPointF closest = m_points.isEmpty() ? point : m_points.first().toPointF();
+    qreal closestDistance = QVector2D(closest - point).lengthSquared();
+    for (const line& segment : segments()) {
+        const QPointF candidate = segment.is_null() ? segment.p1() : Utils::pointOnLineClosestToPoint(segment.p1(), segment.p2(), point);
+        const qreal distance = QVector2D(candidate - point).lengthSquared();
+        if (distance < closestDistance) {
+            closest = candidate;
+            closestDistance = distance;
+        }
+    }
+
+    return closest;
+}
+
+/**
+ * Same as move_junction_by() but the angles of the wire aren't preserved
+ */
+void wire::move_junction_to(int index, const QPointF& moveTo)
+{
+    queue_junction_move(index, moveTo, false);
+}
+
+void wire::queue_junction_move(int index, const QPointF& target, bool preserveAngles)
+{
+    // A push that doesn't move the junction must not hide a later one
+    if (m_points.at(index).toPointF() == target) {
+        return;
+    }
+
+    junction_move& move = m_junction_moves[(index == 0) ? 0 : 1];
+    const quint64 operation = junction_propagation::operation();
+    if (move.operation != operation) {
+        move.operation = operation;
+        move.count = 0;
+    } else if (junction_propagation::is_pending(move.slot) || move.count >= MAX_JUNCTION_MOVES) {
+        return;
+    }
+
+    move.slot = junction_propagation::queue(this, index != 0, target, preserveAngles);
+    move.count++;
+}
+
+/**
+ * Has to be called after the points have been modified to let the manager know
+ * that the geometry of the wire changed.
+ */
+void wire::points_changed()
+{
+    // The junctions on the wire are checked once the moves of the operation are done
+    const quint64 operation = junction_propagation::operation();
+    if (m_unsettled_operation != operation && junction_propagation::changed(this, m_manager)) {
+        m_unsettled_operation = operation;
+    }
+
+    if (m_manager) {
+        m_manager->wire_points_changed(this);
+    }
+}
+
+/**
+ * Replaces all the points of the wire. Unlike the other modifications, this doesn't
+ * move the junctions of the connected wires nor update the attached connectors.
+ */
+void wire::set_points(const QVector<point>& points)
+{
+    about_to_change();
+    m_points = points;
+    points_changed();
+    has_changed();
+}
+
 void wire::remove_point(int index)
 {
+    junction_propagation propagation;
+
     about_to_change();
     // Move the junction on the previous and next segments
     if (index > 0 && index < points_count() - 1) {
         line newSegment(points().at(index - 1).toPointF(), points().at(index + 1).toPointF());
-        move_junctions_to_new_segment(line_segments().at(index - 1), newSegment);
-        move_junctions_to_new_segment(line_segments().at(index), newSegment);
+        move_junctions_to_new_segment(segment(index - 1), newSegment);
+        move_junctions_to_new_segment(segment(index), newSegment);
     } else {
         for (const auto& wire: connected_wires()) {
             for (int junctionIndex: wire->junctions()) {
                 QPointF point = wire->points().at(junctionIndex).toPointF();
-                if (line_segments().first().contains_point(point)) {
-                    wire->move_point_to(junctionIndex, points().at(1).toPointF());
+                if (segments().first().contains_point(point)) {
+                    wire->move_junction_to(junctionIndex, points().at(1).toPointF());
                 }
-                if (line_segments().last().contains_point(point)) {
-                    wire->move_point_to(junctionIndex, points().at(points_count() - 2).toPointF());
+                if (segments().last().contains_point(point)) {
+                    wire->move_junction_to(junctionIndex, points().at(points_count() - 2).toPointF());
                 }
             }
         }
     }
     m_points.remove(index);
+    points_changed();
     has_changed();
     if (m_manager) {
         m_manager->point_removed(this, index);
@@ -1,8 +1,10 @@
 #pragma once
 
 #include "point.h"
+#include "line.h"
 
 #include <QList>
+#include <QVarLengthArray>
 #include <QVector>
 
 #include <memory>
@@ -13,22 +15,59 @@ namespace wire_system
 {
     class manager;
     class net;
-    class line;
 
     class wire
     {
     public:
+        /**
+         * A view of the line segments of a wire. The segments are created on the fly
+         * so that iterating over them doesn't allocate.
+         * \remark The view is invalidated when the points of the wire change.
+         */
+        class segment_view
+        {
+        public:
+            class iterator
+            {
+            public:
+                iterator(const point* point) : m_point(point) { }
+
+                [[nodiscard]] line operator*() const { return line(m_point->toPointF(), (m_point + 1)->toPointF()); }
+                iterator& operator++() { m_point++; return *this; }
+                [[nodiscard]] bool operator==(const iterator& other) const { return m_point == other.m_point; }
+                [[nodiscard]] bool operator!=(const iterator& other) const { return m_point != other.m_point; }
+
+            private:
+                const point* m_point;
+            };
+
+            explicit segment_view(const QVector<point>& points) : m_points(points) { }
+
+            [[nodiscard]] iterator begin() const { return iterator(m_points.constData()); }
+            [[nodiscard]] iterator end() const { return iterator(m_points.constData() + count()); }
+            [[nodiscard]] int count() const { return qMax(m_points.count() - 1, 0); }
+            [[nodiscard]] bool isEmpty() const { return count() == 0; }
+            [[nodiscard]] line at(int index) const { return line(m_points.at(index).toPointF(), m_points.at(index + 1).toPointF()); }
+            [[nodiscard]] line first() const { return at(0); }
+            [[nodiscard]] line last() const { return at(count() - 1); }
+
+        private:
+            const QVector<point>& m_points;
+        };
+
         wire();
         wire(const wire&) = delete;
         wire(wire&&) = delete;
         virtual ~wire() = default;
 
         void set_manager(manager* manager);
-        [[nodiscard]] QVector<point> points() const;
+        [[nodiscard]] const QVector<point>& points() const;
         [[nodiscard]] int points_count() const;
-        [[nodiscard]] QVector<int> junctions() const;
-        [[nodiscard]] QList<wire*> connected_wires();
+        [[nodiscard]] QVarLengthArray<int, 2> junctions() const;
+        [[nodiscard]] const QList<wire*>& connected_wires() const;
         [[nodiscard]] QList<line> line_segments() const;
+        [[nodiscard]] segment_view segments() const;
+        [[nodiscard]] line segment(int index) const;
         virtual void move_point_to(int index, const QPointF& moveTo);
         void set_point_is_junction(int index, bool isJunction);
         virtual void prepend_point(const QPointF& point);
@@ -36,23 +75,30 @@ namespace wire_system
         virtual void insert_point(int index, const QPointF& point);
         void move_point_by(int index, const QVector2D& moveBy);
         [[nodiscard]] bool point_is_on_wire(const QPointF& point) const;
+        [[nodiscard]] QPointF point_closest_to(const QPointF& point) const;
+        void pull_junctions();
         void move(const QVector2D& movedBy);
         void simplify();
         [[nodiscard]] bool connect_wire(wire* wire);
         void setNet(const std::shared_ptr<wire_system::net>& net);
-        [[nodiscard]] std::shared_ptr<wire_system::net> net();
+        [[nodiscard]] std::shared_ptr<wire_system::net> net() const;
         void disconnectWire(wire* wire);
         virtual void add_segment(int index);
         void remove_point(int index);
+        void set_points(const QVector<point>& points);
 
     protected:
         void move_junctions_to_new_segment(const line& oldSegment, const line& newSegment);
         void move_line_segment_by(int index, const QVector2D& moveBy);
         class manager* manager();
+        void points_changed();
 
         QVector<point> m_points;
 
     private:
+        void move_junction_by(int index, const QVector2D& moveBy);
+        void move_junction_to(int index, const QPointF& moveTo);
+        void queue_junction_move(int index, const QPointF& target, bool preserveAngles);
         void remove_duplicate_points();
         void remove_obsolete_points();
         virtual void about_to_change();
@@ -61,5 +107,15 @@ namespace wire_system
         QList<wire*> m_connectedWires;
         std::shared_ptr<wire_system::net> m_net;
         class manager* m_manager;
+
+        // The last queued move of the first and last point as junctions
+        struct junction_move
+        {
+            quint64 operation = 0;      // The operation it was queued in
+            int slot = -1;              // Its position in the queue of that operation
+            int count = 0;              // How often the point was queued during that operation
+        };
+        junction_move m_junction_moves[2];
+        quint64 m_unsettled_operation = 0;     // The operation in which the wire changed and its junctions haven't been pulled since
     };
 }
@@ -0,0 +1,123 @@
+#include "wire_pool.h"
+
+using namespace wire_system;
+
+/**
+ * Stores the wire in a free slot and returns its handle. If the wire is already in
+ * the pool, its existing handle is returned.
+ */
+handle wire_pool::acquire(const std::shared_ptr<wire>& wire)
+{
+    // Sanity check
+    if (!wire) {
+        return { };
+    }
+
+    // The wire might already be in the pool
+    auto it = m_indices.constFind(wire.get());
+    if (it != m_indices.constEnd()) {
+        slot& slot = m_slots[it.value()];
+        if (!slot.ref.expired()) {
+            slot.users++;
+            return { it.value(), slot.generation };
+        }
+
+        // A new wire at the address of a destroyed one, the old handles must not refer to it
+        slot.ref = wire;
+        slot.users = 1;
+        if (++slot.generation == 0) {
+            slot.generation = 1;
+        }
+        return { it.value(), slot.generation };
+    }
+
+    quint32 index;
+    if (m_free.empty()) {
+        index = static_cast<quint32>(m_slots.size());
+        m_slots.push_back({ nullptr, { }, 1, 0 });
+    } else {
+        index = m_free.back();
+        m_free.pop_back();
+    }
+
+    slot& slot = m_slots[index];
+    slot.raw = wire.get();
+    slot.ref = wire;
+    slot.users = 1;
+    m_indices.insert(wire.get(), index);
+
+    return { index, slot.generation };
+}
+
+/**
+ * Releases the wire once it has been released as many times as it was acquired.
+ * Releasing a stale handle does nothing.
+ */
+void wire_pool::release(handle handle)
+{
+    // The slot of a destroyed wire still has to be released
+    if (!is_current(handle)) {
+        return;
+    }
+
+    slot& slot = m_slots[handle.index];
+    if (--slot.users > 0) {
+        return;
+    }
+
+    m_indices.remove(slot.raw);
+    slot.raw = nullptr;
+    slot.ref.reset();
+
+    // Make the old handles stale. Zero is reserved for null handles.
+    if (++slot.generation == 0) {
+        slot.generation = 1;
+    }
+    m_free.push_back(handle.index);
+}
+
+/**
+ * Returns a shared pointer to the wire or nullptr if the handle is stale
+ */
+std::shared_ptr<wire> wire_pool::shared(handle handle) const
+{
+    if (!get(handle)) {
+        return nullptr;
+    }
+
+    return m_slots[handle.index].ref.lock();
+}
+
+/**
+ * Returns the handle of the wire or a null handle if it isn't in the pool
+ */
+handle wire_pool::find(const wire* wire) const
+{
+    auto it = m_indices.constFind(wire);
+    if (it == m_indices.constEnd()) {
+        return { };
+    }
+
+    return { it.value(), m_slots[it.value()].generation };
+}
+
+/**
+ * Returns the address of the wire even if it has been destroyed in the meantime or
+ * nullptr if the handle is stale. The address must not be dereferenced.
+ */
+const wire* wire_pool::address(handle handle) const
+{
+    if (!is_current(handle)) {
+        return nullptr;
+    }
+
+    return m_slots[handle.index].raw;
+}
+
+/**
+ * Returns the number of wires in the pool
+ */
+int wire_pool::count() const
+{
+    return m_indices.count();
+}
@@ -0,0 +1,86 @@
+#pragma once
+
+#include <QtGlobal>
+#include <QHash>
+
+#include <memory>
+#include <vector>
+
+namespace wire_system
+{
+    class wire;
+
+    /**
+     * Refers to a wire stored in a wire_pool. A handle never refers to another wire
+     * once the wire it was created for has been released.
+     */
+    struct handle
+    {
+        quint32 index = 0;
+        quint32 generation = 0;         // 0 for null handles
+
+        [[nodiscard]] bool is_null() const { return generation == 0; }
+        [[nodiscard]] bool operator==(const handle& other) const { return index == other.index && generation == other.generation; }
+        [[nodiscard]] bool operator!=(const handle& other) const { return !(*this == other); }
+    };
+
+    /**
+     * Hands out handles for the wires of the nets. Every wire gets a slot that stays at
+     * the same place until the wire is released. Released slots are reused and their
+     * generation is incremented to make the old handles stale.
+     * The wires themselves aren't stored in the pool. They are still owned by shared
+     * pointers outside of the nets, so the slots keep a weak reference to them and
+     * resolving a handle also checks that the wire still exists.
+     * \remark A wire has a single slot even if it is acquired more than once, the
+     *         slot is released once all the acquisitions have been released.
+     */
+    class wire_pool
+    {
+    public:
+        wire_pool() = default;
+        wire_pool(const wire_pool& other) = delete;
+        wire_pool(wire_pool&& other) = delete;
+        ~wire_pool() = default;
+
+        wire_pool& operator=(const wire_pool& rhs) = delete;
+        wire_pool& operator=(wire_pool&& rhs) = delete;
+
+        handle acquire(const std::shared_ptr<wire>& wire);
+        void release(handle handle);
+        [[nodiscard]] std::shared_ptr<wire> shared(handle handle) const;
+        [[nodiscard]] handle find(const wire* wire) const;
+        [[nodiscard]] const wire* address(handle handle) const;
+        [[nodiscard]] int count() const;
+
+        /**
+         * Returns the wire or nullptr if the handle is stale or the wire has been destroyed
+         */
+        [[nodiscard]] wire* get(handle handle) const
+        {
+            if (!is_current(handle)) {
+                return nullptr;
+            }
+            const slot& slot = m_slots[handle.index];
+            return slot.ref.expired() ? nullptr : slot.raw;
+        }
+
+    private:
+        struct slot
+        {
+            wire* raw;                  // nullptr if the slot is free
+            std::weak_ptr<wire> ref;
+            quint32 generation;
+            int users;                  // The number of times the wire has been acquired
+        };
+
+        [[nodiscard]] bool is_current(handle handle) const
+        {
+            return handle.index < m_slots.size() && m_slots[handle.index].generation == handle.generation;
+        }
+
+        std::vector<slot> m_slots;
+        std::vector<quint32> m_free;
+        QHash<const wire*, quint32> m_indices;
+    };
+
+}